@@ -0,0 +1,67 @@
+"""Benchmarks for the cgrspy binding.
+
+Each bench_* module in this package has a run() function that prints one
+line per measurement, normally the best-of-repeats cost per operation. The
+measurements are also collected in results, so that writeResults() can save
+them as JSON and compareResults() can set them against an earlier run.
+"""
+import json
+import platform
+import sys
+import time
+
+results = []
+
+
+def measure(fn, count, repeat=3):
+    """Calls fn(count) repeat times, returning the best time per operation
+    in nanoseconds."""
+    best = None
+    for i in range(repeat):
+        start = time.time()
+        fn(count)
+        elapsed = time.time() - start
+        if best is None or elapsed < best:
+            best = elapsed
+    return best * 1e9 / count
+
+
+def report(name, value, unit="ns/op", **extra):
+    """Prints a measurement and records it, along with any extra fields (such
+    as allocations per operation), in results."""
+    line = "%-48s %12.1f %s" % (name, value, unit)
+    if "allocations" in extra:
+        line += " %10.1f allocs/op" % extra["allocations"]
+    sys.stdout.write(line + "\n")
+    result = {"name": name, "value": value, "unit": unit}
+    result.update(extra)
+    results.append(result)
+
+
+def writeResults(path):
+    """Writes the results so far to path as a JSON document."""
+    f = open(path, "w")
+    try:
+        json.dump({"python": sys.version.split()[0],
+                   "platform": platform.platform(),
+                   "time": time.time(),
+                   "results": results}, f, indent=1, sort_keys=True)
+        f.write("\n")
+    finally:
+        f.close()
+
+
+def compareResults(path):
+    """Prints, for each result also present in the JSON document at path, its
+    ratio to that earlier value; above 1 is slower for ns/op style units."""
+    f = open(path)
+    try:
+        baseline = dict([(r["name"], r) for r in json.load(f)["results"]])
+    finally:
+        f.close()
+    for r in results:
+        old = baseline.get(r["name"])
+        if old is None or old["unit"] != r["unit"] or not old["value"]:
+            continue
+        sys.stdout.write("%-48s %12.1f %12.1f %8.2fx\n" %
+                         (r["name"], old["value"], r["value"], r["value"] / old["value"]))
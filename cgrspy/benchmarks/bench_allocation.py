@@ -0,0 +1,48 @@
+"""Reuse of wrapper objects from the binding's free-lists.
+
+Builds a model of nComponents components with nVariables variables each, and
+reports the time per element and, for each wrapper type, the fraction of
+allocations served from a free-list.
+"""
+import time
+import cgrspy.bootstrap
+from cgrspy.benchmarks import report
+
+
+def buildModel(cellmlBootstrap, nComponents, nVariables):
+    mod = cellmlBootstrap.createModel("1.1")
+    for i in xrange(nComponents):
+        c = mod.createComponent()
+        c.name = "c%d" % i
+        mod.addElement(c)
+        for j in xrange(nVariables):
+            v = mod.createCellMLVariable()
+            v.name = "v%d" % j
+            v.unitsName = "dimensionless"
+            v.initialValue = "1.0"
+            c.addElement(v)
+    return mod
+
+
+def run(nComponents=1000, nVariables=10):
+    cgrspy.bootstrap.loadGenericModule('cgrs_cellml')
+    cellmlBootstrap = cgrspy.bootstrap.fetch('CreateCellMLBootstrap')
+
+    before = cgrspy.bootstrap.allocationStats()
+    start = time.time()
+    buildModel(cellmlBootstrap, nComponents, nVariables)
+    elapsed = time.time() - start
+    after = cgrspy.bootstrap.allocationStats()
+
+    report("build model (%d components x %d variables)" % (nComponents, nVariables),
+           elapsed * 1e9 / (nComponents * (nVariables + 1)), "ns/element")
+    for name in sorted(after.keys()):
+        allocated = after[name]["allocated"] - before[name]["allocated"]
+        reused = after[name]["reused"] - before[name]["reused"]
+        total = allocated + reused
+        report("%s wrappers reused from free-list" % name,
+               100.0 * reused / total if total else 0.0, "%")
+
+
+if __name__ == '__main__':
+    run()
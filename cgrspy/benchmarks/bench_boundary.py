@@ -0,0 +1,141 @@
+"""Cost of each path across the Python/CGRS boundary.
+
+Runs against the stand-in CGRS in mock/ (build with "python setup.py --mock
+build"), whose objects do next to no work, so that what is measured is the
+binding: objectGetAttr and objectSetAttr, methodCall, objectIterNext,
+conversion of each type in both directions, and callbacks into Python through
+PythonCallback::invokeOnInterface. Sequences are measured from 1 to 1M
+elements, as lists and as numeric arrays.
+
+Each path reports ns/op and allocs/op, where allocations are native CGRS
+objects (values, wrappers) created by the mock plus Object, Method and Enum
+wrappers that could not be taken from a free-list.
+"""
+import array
+import cgrspy.bootstrap
+from cgrspy.benchmarks import measure, report
+
+sequenceSizes = (1, 10, 100, 1000, 10000, 100000, 1000000)
+
+
+class Observer:
+    def results(self, state):
+        pass
+
+    def failed(self, why):
+        pass
+
+    def done(self):
+        pass
+
+
+class Boundary:
+    def __init__(self, service):
+        self.service = service
+        # Reading the counters allocates too; measure that once to subtract.
+        first = self.allocations()
+        self.overhead = self.allocations() - first
+
+    def allocations(self):
+        stats = cgrspy.bootstrap.allocationStats()
+        return self.service.allocationCount + sum([s["allocated"] for s in stats.values()])
+
+    def bench(self, name, fn, count, unit="ns/op", **extra):
+        fn(1)
+        before = self.allocations()
+        fn(count)
+        allocations = (self.allocations() - before - self.overhead) / float(count)
+        report(name, measure(fn, count), unit, allocations=allocations, **extra)
+
+
+def run(count=100000, elements=100000):
+    cgrspy.bootstrap.loadGenericModule('cgrs_mock')
+    service = cgrspy.bootstrap.fetch('CreateMockService')
+    b = Boundary(service)
+    t = service.createThing()
+    kind = t.kind
+
+    def getter(name):
+        def get(n):
+            for i in xrange(n):
+                getattr(t, name)
+        return get
+
+    def setter(name, value):
+        def set(n):
+            for i in xrange(n):
+                setattr(t, name, value)
+        return set
+
+    b.bench("getattr double", getter("value"), count)
+    b.bench("getattr long", getter("index"), count)
+    b.bench("getattr enum", getter("kind"), count)
+    b.bench("getattr object", getter("self"), count)
+    b.bench("getattr string", getter("name"), count)
+    b.bench("getattr wstring", getter("wname"), count)
+    b.bench("setattr double", setter("value", 1.5), count)
+    b.bench("setattr enum", setter("kind", kind), count)
+    b.bench("setattr string", setter("name", "thing"), count)
+    b.bench("setattr wstring", setter("wname", u"thing"), count)
+
+    for length in (8, 1000):
+        service.stringLength = length
+        b.bench("getattr string (%d chars)" % length, getter("text"), count, size=length)
+        b.bench("getattr wstring (%d chars)" % length, getter("wtext"), count, size=length)
+
+    def call(method, *args):
+        def calls(n):
+            for i in xrange(n):
+                method(*args)
+        return calls
+
+    b.bench("call double(double)", call(t.scaled, 2.0), count)
+    b.bench("call long(out string)", call(t.split), count)
+    b.bench("call string(string)", call(service.echoString, "thing"), count)
+    b.bench("call wstring(wstring)", call(service.echoWString, u"thing"), count)
+    b.bench("call enum(enum)", call(service.echoKind, kind), count)
+    b.bench("call object(object)", call(service.echoObject, t), count)
+
+    things = service.createThingSet(1000)
+
+    def iterate(n):
+        for i in xrange(n // 1000):
+            it = things.iterate()
+            while it.next() is not None:
+                pass
+
+    b.bench("iterator next()", iterate, count, "ns/element")
+
+    observer = Observer()
+    b.bench("callback results(sequence<double>[1])",
+            lambda n: service.callObserver(observer, n, 1), count, "ns/call")
+    b.bench("callback results(sequence<double>[1000])",
+            lambda n: service.callObserver(observer, n, 1000), count // 100, "ns/call")
+
+    try:
+        for numeric in (False, True):
+            cgrspy.bootstrap.setNumericArrays(numeric)
+            form = numeric and "array" or "list"
+            for size in sequenceSizes:
+                n = max(1, elements // size)
+                service.sequenceLength = size
+                b.bench("getattr sequence<double>[%d] (%s)" % (size, form),
+                        getter("values"), n, size=size)
+                b.bench("call makeDoubles(%d) (%s)" % (size, form),
+                        call(service.makeDoubles, size), n, size=size)
+    finally:
+        cgrspy.bootstrap.setNumericArrays(False)
+
+    for size in sequenceSizes:
+        n = max(1, elements // size)
+        values = [i * 0.5 for i in xrange(size)]
+        b.bench("pass sequence<double>[%d] (list)" % size,
+                call(service.sumDoubles, values), n, size=size)
+        b.bench("pass sequence<double>[%d] (array)" % size,
+                call(service.sumDoubles, array.array('d', values)), n, size=size)
+        b.bench("pass sequence<long>[%d] (array)" % size,
+                call(service.sumLongs, array.array('i', xrange(size))), n, size=size)
+
+
+if __name__ == '__main__':
+    run()
@@ -0,0 +1,81 @@
+"""Per-element cost of converting values between Python and CGRS.
+
+Every attribute assignment converts its value with pythonToGenericValue, and
+every attribute read converts the result with genericValueToPython, so these
+loops are dominated by the conversion layer.
+
+The sequence case passes a list of doubles to a native operation and converts
+a sequence of doubles back, one element at a time; it needs the stand-in CGRS
+in mock/ (build with "python setup.py --mock build"), and is skipped without
+it. The CellML attribute cases need a CellML API build, and are skipped
+without one.
+"""
+import cgrspy.bootstrap
+from cgrspy.benchmarks import measure, report
+
+
+def loadModule(name):
+    try:
+        cgrspy.bootstrap.loadGenericModule(name)
+    except IOError:
+        return False
+    return True
+
+
+def runSequences(elements, repeat=3):
+    service = cgrspy.bootstrap.fetch('CreateMockService')
+    values = [i * 0.5 for i in xrange(elements)]
+
+    def toNative(n):
+        for i in xrange(n):
+            service.sumDoubles(values)
+
+    def toPython(n):
+        for i in xrange(n):
+            service.makeDoubles(elements)
+
+    report("convert %d doubles (to CGRS)" % elements,
+           measure(toNative, repeat) / elements, "ns/element")
+    report("convert %d doubles (to Python)" % elements,
+           measure(toPython, repeat) / elements, "ns/element")
+
+
+def runAttributes(count):
+    cellmlBootstrap = cgrspy.bootstrap.fetch('CreateCellMLBootstrap')
+    mod = cellmlBootstrap.createModel("1.1")
+    var = mod.createCellMLVariable()
+    var.name = "x"
+    var.initialValue = "1.0"
+
+    def setString(n):
+        for i in xrange(n):
+            var.initialValue = "1.0"
+
+    def getString(n):
+        for i in xrange(n):
+            var.initialValue
+
+    def getEnum(n):
+        for i in xrange(n):
+            var.publicInterface
+
+    def setEnum(n):
+        iface = var.publicInterface
+        for i in xrange(n):
+            var.publicInterface = iface
+
+    report("convert string (setattr)", measure(setString, count))
+    report("convert string (getattr)", measure(getString, count))
+    report("convert enum (setattr)", measure(setEnum, count))
+    report("convert enum (getattr)", measure(getEnum, count))
+
+
+def run(count=100000, elements=100000):
+    if loadModule('cgrs_mock'):
+        runSequences(elements)
+    if loadModule('cgrs_cellml'):
+        runAttributes(count)
+
+
+if __name__ == '__main__':
+    run()
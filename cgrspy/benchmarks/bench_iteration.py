@@ -0,0 +1,38 @@
+"""Cost per element of iterating over a native collection.
+
+Iterates over allComponents of a model with 10000 components, fetching one
+element at a time and then with setIteratorPrefetch batches.
+"""
+import cgrspy.bootstrap
+from cgrspy.benchmarks import measure, report
+
+
+def buildModel(cellmlBootstrap, nComponents):
+    mod = cellmlBootstrap.createModel("1.1")
+    for i in xrange(nComponents):
+        c = mod.createComponent()
+        c.name = "c%d" % i
+        mod.addElement(c)
+    return mod
+
+
+def run(nComponents=10000, batches=(0, 16, 64, 256)):
+    cgrspy.bootstrap.loadGenericModule('cgrs_cellml')
+    cellmlBootstrap = cgrspy.bootstrap.fetch('CreateCellMLBootstrap')
+    mod = buildModel(cellmlBootstrap, nComponents)
+
+    def iterate(n):
+        for c in mod.allComponents:
+            pass
+
+    try:
+        for batch in batches:
+            cgrspy.bootstrap.setIteratorPrefetch(batch)
+            report("iterate %d components (prefetch %d)" % (nComponents, batch),
+                   measure(iterate, nComponents), "ns/element")
+    finally:
+        cgrspy.bootstrap.setIteratorPrefetch(0)
+
+
+if __name__ == '__main__':
+    run()
@@ -0,0 +1,67 @@
+"""Concurrent integration runs that report to Python progress observers.
+
+Starts N ODE integration runs at once, each on its own native thread with its
+own Python observer, and waits for all of them. Integrators call into the
+observers (and take their objid) from those threads, so this measures how
+well callbacks scale when several runs compete for the interpreter.
+"""
+import threading
+import time
+import cgrspy.bootstrap
+from cgrspy.benchmarks import report
+from cgrspy.benchmarks.bench_threads import buildModel
+
+
+class Observer:
+    def __init__(self):
+        self.done_ = threading.Event()
+        self.calls = 0
+
+    def results(self, state):
+        self.calls += 1
+
+    def failed(self, why):
+        self.done_.set()
+
+    def done(self):
+        self.done_.set()
+
+
+def integrateAll(cis, compiledModels, step):
+    observers = []
+    runs = []
+    for compmod in compiledModels:
+        solrun = cis.createODEIntegrationRun(compmod)
+        solrun.setResultRange(0, 10, step)
+        observer = Observer()
+        solrun.setProgressObserver(observer)
+        observers.append(observer)
+        runs.append(solrun)
+
+    start = time.time()
+    for solrun in runs:
+        solrun.start()
+    for observer in observers:
+        observer.done_.wait()
+    return time.time() - start, sum([o.calls for o in observers])
+
+
+def run(runCounts=(1, 2, 4, 8), nEquations=20, step=0.001):
+    for m in ['cgrs_cellml', 'cgrs_xpcom', 'cgrs_cis', 'cgrs_ccgs',
+              'cgrs_telicems']:
+        cgrspy.bootstrap.loadGenericModule(m)
+    cellmlBootstrap = cgrspy.bootstrap.fetch('CreateCellMLBootstrap')
+    telicems = cgrspy.bootstrap.fetch('CreateTeLICeMService')
+    cis = cgrspy.bootstrap.fetch('CreateIntegrationService')
+
+    for n in runCounts:
+        compiled = [cis.compileModelODE(buildModel(cellmlBootstrap, telicems, nEquations))
+                    for i in range(n)]
+        elapsed, calls = integrateAll(cis, compiled, step)
+        report("integrate x%d with observers" % n, elapsed, "s")
+        if calls:
+            report("integrate x%d observer callback" % n, elapsed * 1e9 / calls, "ns/call")
+
+
+if __name__ == '__main__':
+    run()
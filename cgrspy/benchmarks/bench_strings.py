@@ -0,0 +1,43 @@
+"""Conversion of wide strings, by serialising a large model document.
+
+Builds a model of nComponents components with nVariables variables each,
+then reports the time per character to fetch its serialised text and to
+load a model back from that text, and to round-trip long names.
+"""
+import cgrspy.bootstrap
+from cgrspy.benchmarks import measure, report
+from cgrspy.benchmarks.bench_allocation import buildModel
+
+
+def run(nComponents=1000, nVariables=10, nameLength=100000):
+    cgrspy.bootstrap.loadGenericModule('cgrs_cellml')
+    cellmlBootstrap = cgrspy.bootstrap.fetch('CreateCellMLBootstrap')
+    mod = buildModel(cellmlBootstrap, nComponents, nVariables)
+
+    text = mod.serialisedText
+    report("serialised model", len(text), "chars")
+
+    def serialise(count):
+        for i in xrange(count):
+            mod.serialisedText
+    report("serialisedText", measure(serialise, 5) / len(text), "ns/char")
+
+    loader = cellmlBootstrap.modelLoader
+    def load(count):
+        for i in xrange(count):
+            loader.createFromText(text)
+    report("createFromText", measure(load, 5) / len(text), "ns/char")
+
+    comp = mod.createComponent()
+    for label, name in [("ASCII", "n" * nameLength),
+                        ("non-ASCII", u"\xe9\u4e2d" * (nameLength // 2))]:
+        def roundTrip(count):
+            for i in xrange(count):
+                comp.name = name
+                comp.name
+        report("%s name set and get (%d chars)" % (label, len(name)),
+               measure(roundTrip, 20) / len(name), "ns/char")
+
+
+if __name__ == '__main__':
+    run()
@@ -0,0 +1,72 @@
+"""Scaling of native calls across Python threads.
+
+Each of N Python threads compiles its own model with compileModelODE. While
+the GIL is released around native invocations the compiles run in parallel;
+with setGILPolicy(False) they serialise.
+"""
+import threading
+import time
+import cgrspy.bootstrap
+from cgrspy.benchmarks import report
+
+
+def buildModel(cellmlBootstrap, telicems, nEquations):
+    mod = cellmlBootstrap.createModel("1.1")
+    c = mod.createComponent()
+    c.name = "main"
+    mod.addElement(c)
+
+    vtime = mod.createCellMLVariable()
+    vtime.name = "time"
+    vtime.unitsName = "dimensionless"
+    c.addElement(vtime)
+
+    od = mod.domElement.ownerDocument
+    for i in range(nEquations):
+        v = mod.createCellMLVariable()
+        v.name = "x%d" % i
+        v.unitsName = "dimensionless"
+        v.initialValue = "1.0"
+        c.addElement(v)
+        tr = telicems.parseMaths(od, "d(x%d)/d(time) = x%d" % (i, i))
+        c.addMath(tr.mathResult)
+    return mod
+
+
+def compileAll(cis, models):
+    threads = [threading.Thread(target=cis.compileModelODE, args=(m,))
+               for m in models]
+    start = time.time()
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    return time.time() - start
+
+
+def run(threadCounts=(1, 2, 4, 8), nEquations=200):
+    for m in ['cgrs_cellml', 'cgrs_xpcom', 'cgrs_cis', 'cgrs_ccgs',
+              'cgrs_telicems']:
+        cgrspy.bootstrap.loadGenericModule(m)
+    cellmlBootstrap = cgrspy.bootstrap.fetch('CreateCellMLBootstrap')
+    telicems = cgrspy.bootstrap.fetch('CreateTeLICeMService')
+    cis = cgrspy.bootstrap.fetch('CreateIntegrationService')
+
+    for release in (True, False):
+        cgrspy.bootstrap.setGILPolicy(release)
+        single = None
+        for n in threadCounts:
+            models = [buildModel(cellmlBootstrap, telicems, nEquations)
+                      for i in range(n)]
+            elapsed = compileAll(cis, models)
+            if single is None:
+                single = elapsed / n
+            label = "compileModelODE x%d (%s)" % \
+                    (n, release and "GIL released" or "GIL held")
+            report(label, elapsed, "s")
+            report(label + " speedup", single * n / elapsed, "x")
+    cgrspy.bootstrap.setGILPolicy(True)
+
+
+if __name__ == '__main__':
+    run()
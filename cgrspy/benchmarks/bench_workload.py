@@ -0,0 +1,134 @@
+"""End-to-end workload: build, parse, compile and integrate a model.
+
+Generates a model with N components and M ODEs (spread evenly over the
+components, which share the variable of integration from the first one)
+through the binding, parses each ODE with TeLICeM, compiles the model with
+compileModelODE and integrates it with a Python progress observer, as
+test_callback does. Each phase reports its time, the number of crossings of
+the Python/native boundary it made (see crossingCounts) and the peak RSS of
+the process at its end. The models are generated deterministically, so runs
+are comparable between builds.
+"""
+import resource
+import threading
+import time
+import cgrspy.bootstrap
+from cgrspy.benchmarks import report
+
+
+class Interface:
+    def __init__(self, asString):
+        self.asString = asString
+
+
+class Observer:
+    def __init__(self):
+        self.finished = threading.Event()
+        self.values = 0
+
+    def results(self, state):
+        self.values += len(state)
+
+    def failed(self, why):
+        self.finished.set()
+
+    def done(self):
+        self.finished.set()
+
+
+def crossings():
+    counts = cgrspy.bootstrap.crossingCounts()
+    return counts["native"] + counts["python"]
+
+
+def peakRSS():
+    # ru_maxrss is in kilobytes on Linux.
+    return resource.getrusage(resource.RUSAGE_SELF).ru_maxrss / 1024.0
+
+
+def addVariable(mod, c, name, interface=None, initialValue=None):
+    v = mod.createCellMLVariable()
+    v.name = name
+    v.unitsName = "dimensionless"
+    if interface is not None:
+        v.publicInterface = Interface(interface)
+    if initialValue is not None:
+        v.initialValue = initialValue
+    c.addElement(v)
+    return v
+
+
+def buildModel(cellmlBootstrap, nComponents, nODEs):
+    mod = cellmlBootstrap.createModel("1.1")
+    components = []
+    for i in xrange(nComponents):
+        c = mod.createComponent()
+        c.name = "c%d" % i
+        mod.addElement(c)
+        addVariable(mod, c, "time", i == 0 and "out" or "in")
+        components.append(c)
+        if i == 0:
+            continue
+        conn = mod.createConnection()
+        conn.componentMapping.firstComponentName = "c0"
+        conn.componentMapping.secondComponentName = c.name
+        mv = mod.createMapVariables()
+        mv.firstVariableName = "time"
+        mv.secondVariableName = "time"
+        conn.addElement(mv)
+        mod.addElement(conn)
+    for j in xrange(nODEs):
+        addVariable(mod, components[j % nComponents], "x%d" % j, initialValue="1.0")
+    return mod, components
+
+
+def addMaths(mod, components, telicems, nODEs):
+    od = mod.domElement.ownerDocument
+    for j in xrange(nODEs):
+        tr = telicems.parseMaths(od, "d(x%d)/d(time) = x%d" % (j, j))
+        components[j % len(components)].addMath(tr.mathResult)
+
+
+def integrate(cis, compmod, step):
+    solrun = cis.createODEIntegrationRun(compmod)
+    solrun.setResultRange(0, 1, step)
+    observer = Observer()
+    solrun.setProgressObserver(observer)
+    solrun.start()
+    observer.finished.wait()
+    return observer.values
+
+
+def phase(label, fn, *args):
+    """Runs fn(*args) as one phase, reporting its cost, and returns what it
+    returned."""
+    before = crossings()
+    start = time.time()
+    result = fn(*args)
+    report(label, time.time() - start, "s")
+    report(label + " crossings", crossings() - before, "crossings")
+    report(label + " peak RSS", peakRSS(), "MB")
+    return result
+
+
+def run(sizes=((1, 10), (10, 100), (100, 1000)), step=0.001):
+    for m in ['cgrs_cellml', 'cgrs_xpcom', 'cgrs_cis', 'cgrs_ccgs',
+              'cgrs_telicems']:
+        cgrspy.bootstrap.loadGenericModule(m)
+    cellmlBootstrap = cgrspy.bootstrap.fetch('CreateCellMLBootstrap')
+    telicems = cgrspy.bootstrap.fetch('CreateTeLICeMService')
+    cis = cgrspy.bootstrap.fetch('CreateIntegrationService')
+
+    for nComponents, nODEs in sizes:
+        label = "workload %d components x %d ODEs" % (nComponents, nODEs)
+        start = time.time()
+        mod, components = phase(label + " build", buildModel,
+                                cellmlBootstrap, nComponents, nODEs)
+        phase(label + " parse", addMaths, mod, components, telicems, nODEs)
+        compmod = phase(label + " compile", cis.compileModelODE, mod)
+        phase(label + " integrate", integrate, cis, compmod, step)
+        report(label + " total", time.time() - start, "s")
+
+
+if __name__ == '__main__':
+    run()
@@ -1,37 +1,111 @@
 #include <Python.h>
 #include <structmember.h>
+#include <pythread.h>
 #undef HAVE_SYS_TYPES_H // Avoid warning
 #include "IfaceCGRS.hxx"
 #include "CGRSBootstrap.hpp"
 #include "cellml-api-cxx-support.hpp"
-#include <sstream>
-#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+class InterfaceSet;
+struct ResolvedMember;
+struct CallbackMember;
+class NativeObserver;
 
 typedef struct {
     PyObject_HEAD
     iface::XPCOM::IObject* mObject;
+    // Computed on first member access and reused after that.
+    iface::CGRS::ObjectValue* mObjectValue;
+    InterfaceSet* mInterfaceSet;
+    // Results of next() fetched ahead of time for an iterator, and the
+    // position of the first one not yet returned.
+    PyObject* mPrefetched;
+    Py_ssize_t mPrefetchPos;
+    // The error that ended the prefetched batch, if any, to be raised once
+    // the results before it have been returned.
+    PyObject* mPrefetchErrorType;
+    PyObject* mPrefetchErrorValue;
+    PyObject* mPrefetchErrorTraceback;
 } Object;
 
 typedef struct {
   PyObject_HEAD
   PyObject* asString;
   int asInteger;
+  // Set on the shared instances returned for native enum values, which must
+  // not be changed.
+  int mInterned;
 } Enum;
 
 typedef struct {
   PyObject_HEAD
   iface::CGRS::GenericMethod* mInvokeMethod;
   iface::CGRS::ObjectValue* mInvokeOn;
+  // The operation this method was resolved from, which also describes its
+  // parameters.
+  const ResolvedMember* mMember;
+  // For the next() operation of an iterator, the iterator's wrapper, whose
+  // prefetched results must be returned first.
+  Object* mIterator;
 } Method;
 
+// A contiguous array of numbers, used (optionally) for numeric sequences
+// returned by native code so that they need not be boxed one by one.
+typedef struct {
+  PyObject_HEAD
+  char* mData;
+  Py_ssize_t mLength;
+  Py_ssize_t mItemSize;
+  // A struct module format string, e.g. "d".
+  char mFormat[2];
+  // The object owning mData if the array is a read-only view of another
+  // object's memory, or NULL if the array owns it.
+  PyObject* mOwner;
+} NumericArray;
+
+// A native progress observer (a ResultRecorder or a ColumnarSink).
+typedef struct {
+  PyObject_HEAD
+  NativeObserver* mObserver;
+} Observer;
+
+// A columnar results file written by a ColumnarSink, mapped for reading.
+typedef struct {
+  PyObject_HEAD
+  char* mMap;
+  size_t mMapSize;
+  // The rows, and the rows allocated per column, when the file was opened.
+  Py_ssize_t mRows;
+  Py_ssize_t mRowCapacity;
+  int mRateCount;
+  int mAlgebraicCount;
+} ColumnarFile;
+
 static void ObjectDealloc(Object* self);
+static long objectHash(Object* self);
+static PyObject* objectRichCompare(PyObject* aA, PyObject* aB, int aOp);
 static void EnumDealloc(Enum* self);
 static int EnumInit(Enum *self, PyObject *args, PyObject *kwds);
+static int enumSetAttr(PyObject* aObj, PyObject* aName, PyObject* aValue);
 static PyObject *EnumNew(PyTypeObject *type, PyObject *args, PyObject *kwds);
 
 static PyObject* genericValueToPython(iface::CGRS::GenericValue* aGenVal);
 static already_AddRefd<iface::CGRS::GenericValue> pythonToGenericValue(PyObject* aObj, iface::CGRS::GenericType* aType);
 
+static iface::CGRS::ObjectValue* objectValue(Object* aObj, iface::CGRS::GenericsService* aCGS);
 static PyObject* objectGetAttr(PyObject* aObj, char* aName);
 static int objectSetAttr(PyObject* aObj, char* aName, PyObject* aValue);
 static PyObject* objectIterNext(PyObject *aObj);
@@ -42,16 +116,223 @@ static PyObject* methodNew(PyTypeObject *type, PyObject* args, PyObject* kwds);
 static void methodDealloc(Method* self);
 static PyObject* methodCall(Method* self, PyObject* args, PyObject* kwds);
 
+static NumericArray* numericArrayNew(char aFormat, Py_ssize_t aItemSize, Py_ssize_t aLength);
+static void numericArrayDealloc(NumericArray* self);
+static Py_ssize_t numericArrayLength(NumericArray* self);
+static PyObject* numericArrayItem(NumericArray* self, Py_ssize_t aIndex);
+static PyObject* numericArraySlice(NumericArray* self, Py_ssize_t aLow, Py_ssize_t aHigh);
+static PyObject* numericArrayConcat(NumericArray* self, PyObject* aOther);
+static PyObject* numericArrayToList(NumericArray* self);
+static int numericArrayGetBuffer(NumericArray* self, Py_buffer* aView, int aFlags);
+static Py_ssize_t numericArrayGetReadBuffer(NumericArray* self, Py_ssize_t aSegment, void** aPtr);
+static Py_ssize_t numericArrayGetWriteBuffer(NumericArray* self, Py_ssize_t aSegment, void** aPtr);
+static Py_ssize_t numericArrayGetSegCount(NumericArray* self, Py_ssize_t* aLength);
+static void observerDealloc(Observer* self);
+static Py_ssize_t recorderLength(Observer* self);
+static PyObject* recorderItem(Observer* self, Py_ssize_t aIndex);
+static PyObject* observerWait(Observer* self, PyObject* args);
+static PyObject* recorderColumn(Observer* self, PyObject* args);
+static PyObject* recorderGetRowLength(Observer* self, void* aClosure);
+static PyObject* observerGetFinished(Observer* self, void* aClosure);
+static PyObject* observerGetError(Observer* self, void* aClosure);
+static int recorderGetBuffer(Observer* self, Py_buffer* aView, int aFlags);
+static void recorderReleaseBuffer(Observer* self, Py_buffer* aView);
+static Py_ssize_t sinkLength(Observer* self);
+static PyObject* sinkGetPath(Observer* self, void* aClosure);
+static void columnarFileDealloc(ColumnarFile* self);
+static Py_ssize_t columnarFileLength(ColumnarFile* self);
+static PyObject* columnarFileColumn(ColumnarFile* self, PyObject* args);
+static PyObject* columnarFileGetStatus(ColumnarFile* self, void* aClosure);
+static PyObject* columnarFileGetNames(ColumnarFile* self, void* aClosure);
+static PyObject* columnarFileGetKinds(ColumnarFile* self, void* aClosure);
+// The CGRS GenericsService, fetched once when the module is initialised.
+static iface::CGRS::GenericsService* sCGS = NULL;
+
+// Crossings of the boundary: native invocations made from Python, and calls
+// from native code into Python. Only updated with the GIL held.
+static unsigned long long sNativeCalls = 0;
+static unsigned long long sPythonCalls = 0;
+
+// The monotonic time in nanoseconds, for timing and tracing calls.
+static uint64_t
+nowNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Tracing of native calls, callbacks, waits for the GIL and its release, for
+// export as Chrome trace events (see bootstrap_dumpTrace). Each thread appends
+// events to its own fixed-size buffer without locking; a buffer is only
+// written by its thread, and read (with the GIL held) by dumpTrace. When a
+// thread exits its buffer is kept, so that its events stay in the trace, and
+// is handed to a new thread once a later trace has started; setTracing frees
+// the events of such buffers when it starts a trace.
+struct TraceEvent
+{
+  const char* name;
+  const char* category;
+  uint64_t time;
+  char phase;
+};
+
+struct TraceBuffer
+{
+  long thread;
+  // Whether a thread is using the buffer, or (briefly) setTracing is freeing
+  // its events.
+  std::atomic<bool> owned;
+  TraceEvent* events;
+  size_t capacity;
+  // The trace the events belong to; see sTraceGeneration.
+  std::atomic<unsigned long> generation;
+  std::atomic<size_t> count;
+  // Events that did not fit.
+  std::atomic<unsigned long long> dropped;
+  TraceBuffer* next;
+};
+
+static std::atomic<bool> sTracing(false);
+// Bumped (with the GIL held) each time a trace is started; each thread empties
+// its buffer when it first records an event for the new trace.
+static std::atomic<unsigned long> sTraceGeneration(0);
+static std::atomic<size_t> sTraceCapacity(65536);
+static std::atomic<TraceBuffer*> sTraceBuffers(NULL);
+
+// Gives up the thread's buffer when the thread exits.
+struct TraceBufferOwner
+{
+  TraceBuffer* buffer;
+
+  ~TraceBufferOwner()
+  {
+    if (buffer != NULL)
+      buffer->owned.store(false, std::memory_order_release);
+  }
+};
+static thread_local TraceBufferOwner tTraceBuffer = {NULL};
+
+// Claims the buffer of a thread that has exited, if its events are from an
+// earlier trace, or returns NULL.
+static TraceBuffer*
+claimTraceBuffer()
+{
+  for (TraceBuffer* b = sTraceBuffers.load(std::memory_order_acquire); b != NULL; b = b->next)
+  {
+    bool owned = false;
+    if (b->owned.load(std::memory_order_relaxed) ||
+        !b->owned.compare_exchange_strong(owned, true, std::memory_order_acquire))
+      continue;
+    // Generations only increase, so one from an earlier trace stays earlier.
+    if (b->generation.load(std::memory_order_relaxed) != sTraceGeneration.load(std::memory_order_acquire))
+      return b;
+    b->owned.store(false, std::memory_order_release);
+  }
+  return NULL;
+}
+
+static bool
+tracing()
+{
+  return sTracing.load(std::memory_order_relaxed);
+}
+
+static void
+traceEvent(const char* aName, const char* aCategory, char aPhase)
+{
+  unsigned long generation = sTraceGeneration.load(std::memory_order_acquire);
+  TraceBuffer* b = tTraceBuffer.buffer;
+  if (b == NULL)
+  {
+    b = claimTraceBuffer();
+    if (b == NULL)
+    {
+      b = new TraceBuffer;
+      b->owned.store(true, std::memory_order_relaxed);
+      b->events = NULL;
+      b->capacity = 0;
+      b->generation.store(0, std::memory_order_relaxed);
+      b->count.store(0, std::memory_order_relaxed);
+      b->dropped.store(0, std::memory_order_relaxed);
+      b->next = sTraceBuffers.load(std::memory_order_relaxed);
+      while (!sTraceBuffers.compare_exchange_weak(b->next, b, std::memory_order_release,
+                                                  std::memory_order_relaxed))
+        ;
+    }
+    // Read by dumpTrace only once the buffer's generation is current.
+    b->thread = PyThread_get_thread_ident();
+    tTraceBuffer.buffer = b;
+  }
+
+  if (b->generation.load(std::memory_order_relaxed) != generation)
+  {
+    // dumpTrace skips the buffer until the new generation is published.
+    size_t capacity = sTraceCapacity.load(std::memory_order_relaxed);
+    if (capacity != b->capacity)
+    {
+      delete [] b->events;
+      b->events = new TraceEvent[capacity];
+      b->capacity = capacity;
+    }
+    b->count.store(0, std::memory_order_relaxed);
+    b->dropped.store(0, std::memory_order_relaxed);
+    b->generation.store(generation, std::memory_order_release);
+  }
+
+  size_t n = b->count.load(std::memory_order_relaxed);
+  if (n == b->capacity)
+  {
+    b->dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  TraceEvent& e = b->events[n];
+  e.name = aName;
+  e.category = aCategory;
+  e.time = nowNs();
+  e.phase = aPhase;
+  b->count.store(n + 1, std::memory_order_release);
+}
+
+// Records a begin event now and the matching end event when it goes out of
+// scope, if given a name; callers pass NULL when not tracing.
+class ScopedTrace
+{
+public:
+  ScopedTrace(const char* aName, const char* aCategory)
+    : mName(aName), mCategory(aCategory)
+  {
+    if (mName != NULL)
+      traceEvent(mName, mCategory, 'B');
+  }
+
+  ~ScopedTrace()
+  {
+    if (mName != NULL)
+      traceEvent(mName, mCategory, 'E');
+  }
+
+private:
+  const char* mName;
+  const char* mCategory;
+};
+
+static const char* const kGILWait = "wait for GIL";
+static const char* const kGILRelease = "release GIL";
+
 class ScopedGIL
 {
 public:
   ScopedGIL()
   {
+    ScopedTrace trace(tracing() ? kGILWait : NULL, "gil");
     mState = PyGILState_Ensure();
   }
 
   ~ScopedGIL()
   {
+    // The GIL is only released if it was not already held.
+    if (mState == PyGILState_UNLOCKED && tracing())
+      traceEvent(kGILRelease, "gil", 'i');
     PyGILState_Release(mState);
   }
 
@@ -59,6 +340,101 @@ private:
   PyGILState_STATE mState;
 };
 
+// Releases the GIL (if asked to) for the lifetime of the object, so that
+// other Python threads can run during a long native call.
+class ScopedGILRelease
+{
+public:
+  ScopedGILRelease(bool aRelease)
+    : mState(NULL)
+  {
+    if (!aRelease)
+      return;
+    if (tracing())
+      traceEvent(kGILRelease, "gil", 'i');
+    mState = PyEval_SaveThread();
+  }
+
+  ~ScopedGILRelease()
+  {
+    if (mState != NULL)
+    {
+      ScopedTrace trace(tracing() ? kGILWait : NULL, "gil");
+      PyEval_RestoreThread(mState);
+    }
+  }
+
+private:
+  PyThreadState* mState;
+};
+
+// Whether the calling thread holds the GIL.
+static bool
+holdsGIL()
+{
+  PyThreadState* ts = PyGILState_GetThisThreadState();
+  return ts != NULL && ts == _PyThreadState_Current;
+}
+
+// Python references dropped by threads that don't hold the GIL, released
+// later by a thread that does. Pushed without locking.
+struct PendingDecref
+{
+  PyObject* object;
+  PendingDecref* next;
+};
+static std::atomic<PendingDecref*> sPendingDecrefs(NULL);
+// Whether a pending call to release them has been scheduled and not yet run.
+static std::atomic<bool> sDecrefsScheduled(false);
+
+static int
+releasePendingDecrefs(void*)
+{
+  if (sPendingDecrefs.load(std::memory_order_relaxed) == NULL)
+    return 0;
+  PendingDecref* p = sPendingDecrefs.exchange(NULL, std::memory_order_acquire);
+  while (p != NULL)
+  {
+    PendingDecref* next = p->next;
+    Py_DECREF(p->object);
+    delete p;
+    p = next;
+  }
+  return 0;
+}
+
+static int
+releaseScheduledDecrefs(void*)
+{
+  sDecrefsScheduled.store(false, std::memory_order_release);
+  return releasePendingDecrefs(NULL);
+}
+
+// Py_DECREFs aObject now if we hold the GIL, and otherwise queues it for the
+// interpreter to release (as a pending call, or at the next callback). If
+// the pending call cannot be added, the next deferDecref tries again.
+static void
+deferDecref(PyObject* aObject)
+{
+  if (holdsGIL())
+  {
+    Py_DECREF(aObject);
+    return;
+  }
+
+  PendingDecref* p = new PendingDecref;
+  p->object = aObject;
+  p->next = sPendingDecrefs.load(std::memory_order_relaxed);
+  while (!sPendingDecrefs.compare_exchange_weak(p->next, p, std::memory_order_release,
+                                                std::memory_order_relaxed))
+    ;
+  if (!sDecrefsScheduled.exchange(true, std::memory_order_acq_rel) &&
+      Py_AddPendingCall(releaseScheduledDecrefs, NULL) != 0)
+    sDecrefsScheduled.store(false, std::memory_order_release);
+}
+
+// The type of all Python objects passed to CGRS. There is a single instance,
+// which is never deleted.
 class PythonObjectType
   : public iface::CGRS::GenericType
 {
@@ -68,11 +444,10 @@ public:
   {
   }
 
-  void add_ref() throw() { refcount++; }
+  void add_ref() throw() { refcount.fetch_add(1, std::memory_order_relaxed); }
   void release_ref() throw()
   {
-    refcount--;
-    if (refcount == 0)
+    if (refcount.fetch_sub(1, std::memory_order_acq_rel) == 1)
       delete this;
   }
   std::string objid() throw()
@@ -99,68 +474,59 @@ public:
     return "XPCOM::IObject";
   }
 private:
-  int refcount;
+  std::atomic<int> refcount;
 };
 
+static PythonObjectType sPythonObjectType;
+
+// An objid built from an address, which identifies an object for as long as it
+// is alive, so that objid() never needs the GIL. The digits are offset so that
+// the id has no NUL characters.
+static std::string
+makeObjid(const void* aAddress)
+{
+  std::string ret;
+  uintptr_t val = reinterpret_cast<uintptr_t>(aAddress);
+  do
+  {
+    ret += static_cast<char>((val % 254) + 1);
+    val /= 254;
+  }
+  while (val != 0);
+  return ret;
+}
+
 class PythonCallback
   : public iface::CGRS::CallbackObjectValue
 {
 public:
   PythonCallback(PyObject* aPyObject)
-    : mPyObject(aPyObject), refcount(1)
+    : mPyObject(aPyObject), refcount(1), mObjid(makeObjid(aPyObject))
   {
     Py_INCREF(mPyObject);
   }
 
   ~PythonCallback()
   {
-    Py_DECREF(mPyObject);
+    // Native code may drop the last reference on any thread, including while
+    // a native call has released the GIL, so don't wait for the GIL here.
+    deferDecref(mPyObject);
   }
 
   void add_ref() throw()
   {
-    refcount++;
+    refcount.fetch_add(1, std::memory_order_relaxed);
   }
   
   void release_ref() throw()
   {
-    refcount--;
-    if (refcount == 0)
+    if (refcount.fetch_sub(1, std::memory_order_acq_rel) == 1)
       delete this;
   }
 
   std::string objid() throw()
   {
-    std::string ret;
-    ScopedGIL gil;
-    long val = PyObject_Hash(mPyObject);
-    ret += (val % 254) + 1;
-    val /= 254;
-
-    ret += (val % 254) + 1;
-    val /= 254;
-
-    ret += (val % 254) + 1;
-    val /= 254;
-
-    ret += (val % 254) + 1;
-    val /= 254;
-
-    ret += (val % 254) + 1;
-    val /= 254;
-
-    ret += (val % 254) + 1;
-    val /= 254;
-
-    ret += (val % 254) + 1;
-    val /= 254;
-
-    ret += (val % 254) + 1;
-    val /= 254;
-
-    ret += (val % 254) + 1;
-    
-    return ret;
+    return mObjid;
   }
 
   void*
@@ -194,7 +560,8 @@ public:
 
   already_AddRefd<iface::CGRS::GenericType> typeOfValue() throw()
   {
-    return new PythonObjectType();
+    sPythonObjectType.add_ref();
+    return &sPythonObjectType;
   }
 
   already_AddRefd<iface::CGRS::GenericValue>
@@ -202,155 +569,689 @@ public:
                     const std::vector<iface::CGRS::GenericValue*>& aInValues,
                     std::vector<iface::CGRS::GenericValue*>& aOutValues,
                     bool* aWasException
-                    ) throw()
+                    ) throw();
+
+  // Calls the Python implementation of a member with aArgs, for a call that
+  // was queued. Called with the GIL held.
+  void deliver(const std::string& aInterfaceName, const std::string& aMethodName,
+               PyObject* aArgs);
+
+private:
+  // Returns a new reference to the Python callable implementing aMember, or
+  // NULL if there is none. It is looked up on every call, so that handlers
+  // can be replaced or added while native code holds the object; that costs
+  // about 100 ns a callback more than keeping it. Called with the GIL held.
+  PyObject* findCallable(const CallbackMember* aMember, const std::string& aInterfaceName,
+                         const std::string& aMethodName);
+
+  PyObject* mPyObject;
+  std::atomic<int> refcount;
+  std::string mObjid;
+};
+
+// A progress observer implemented natively, which native code can call on any
+// thread without the GIL. It handles the results, done and failed members of
+// an integration progress observer; calls to anything else are ignored.
+class NativeObserver
+  : public iface::CGRS::CallbackObjectValue
+{
+public:
+  NativeObserver()
+    : refcount(1), mObjid(makeObjid(this)), mFinished(false), mFailed(false)
   {
-    ObjRef<iface::CGRS::GenericsService> cgs(CreateGenericsService());
+  }
 
-    // One Python type can map to multiple GenericValue types, and so we have to
-    // look up the type to produce the correct output...
-    ObjRef<iface::CGRS::GenericInterface> gi;
-    try { gi = cgs->getInterfaceByName(aInterfaceName); } catch (...) {}
-    if (gi == NULL)
-      return cgs->makeVoid();
+  virtual ~NativeObserver()
+  {
+  }
 
-    ObjRef<iface::CGRS::GenericMethod> gm;
-    ObjRef<iface::CGRS::GenericAttribute> ga;
-    try { ga = gi->getAttributeByName(aMethodName.c_str()); } catch (...) {}
-    if (ga != NULL)
-    {
-      if (aInValues.size() == 0)
-        gm = ga->getter();
-      else
-        gm = ga->setter();
-    }
-    else
-    {
-      try { gm = gi->getOperationByName(aMethodName); } catch (...) {}
-    }
+  void add_ref() throw()
+  {
+    refcount.fetch_add(1, std::memory_order_relaxed);
+  }
 
-    if (gm == NULL)
-      return cgs->makeVoid();
+  void release_ref() throw()
+  {
+    if (refcount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      delete this;
+  }
 
-    ScopedGIL gil;
+  std::string objid() throw()
+  {
+    return mObjid;
+  }
 
-    PyObject* meth = PyObject_GetAttrString(mPyObject, aMethodName.c_str());
-    if (meth == NULL)
-    {
-      PyErr_Clear();
+  void*
+  query_interface(const std::string& aIface) throw()
+  {
+    add_ref();
+    if (aIface == "XPCOM::IObject")
+      return reinterpret_cast<void*>(static_cast<iface::XPCOM::IObject*>(this));
+    else if (aIface == "CGRS::GenericValue")
+      return reinterpret_cast<void*>(static_cast<iface::CGRS::GenericValue*>(this));
+    else if (aIface == "CGRS::CallbackObjectValue")
+      return reinterpret_cast<void*>(static_cast<iface::CGRS::CallbackObjectValue*>(this));
+    release_ref();
+    return NULL;
+  }
+
+  std::vector<std::string>
+  supported_interfaces() throw()
+  {
+    std::vector<std::string> v;
+    v.push_back("XPCOM::IObject");
+    v.push_back("CGRS::CallbackObjectValue");
+    return v;
+  }
+
+  already_AddRefd<iface::CGRS::GenericType> typeOfValue() throw()
+  {
+    sPythonObjectType.add_ref();
+    return &sPythonObjectType;
+  }
 
-      // Check for the explicitly named version...
-      std::string ename;
-      bool skipnext = false;
-      for (std::string::const_iterator i = aInterfaceName.begin(); i != aInterfaceName.end(); i++)
+  already_AddRefd<iface::CGRS::GenericValue>
+  invokeOnInterface(const std::string&, const std::string& aMethodName,
+                    const std::vector<iface::CGRS::GenericValue*>& aInValues,
+                    std::vector<iface::CGRS::GenericValue*>&,
+                    bool* aWasException
+                    ) throw()
+  {
+    *aWasException = false;
+    if (aMethodName == "results" && aInValues.size() == 1)
+    {
+      DECLARE_QUERY_INTERFACE_OBJREF(sv, aInValues[0], CGRS::SequenceValue);
+      if (sv == NULL)
       {
-        if (skipnext)
-        {
-          skipnext = false;
-          continue;
-        }
-        if (*i == ':')
+        *aWasException = true;
+        return sCGS->makeVoid();
+      }
+      // Unbox outside the lock, so that readers are never kept waiting on CGRS.
+      std::vector<double> values(sv->valueCount());
+      for (size_t i = 0; i < values.size(); i++)
+      {
+        ObjRef<iface::CGRS::GenericValue> svi(sv->getValueByIndex(i));
+        DECLARE_QUERY_INTERFACE_OBJREF(dv, svi, CGRS::DoubleValue);
+        if (dv == NULL)
         {
-          ename += '_';
-          skipnext = true;
+          *aWasException = true;
+          return sCGS->makeVoid();
         }
-        else
-          ename += *i;
+        values[i] = dv->asDouble();
       }
-      ename += '_';
-      ename += aMethodName;
-      meth = PyObject_GetAttrString(mPyObject, ename.c_str());
-
-      if (meth == NULL)
-        return cgs->makeVoid();
+      std::lock_guard<std::mutex> lock(mMutex);
+      if (!mFinished)
+        appendResults(values);
     }
-
-    std::vector<PyObject*> gen;
-    PyObject* ptin = PyTuple_New(aInValues.size());
-    int pos = 0;
-    for (std::vector<iface::CGRS::GenericValue*>::const_iterator i = aInValues.begin(); i != aInValues.end(); i++)
-      PyTuple_SET_ITEM(ptin, pos++, genericValueToPython(*i));
-    
-    PyObject* ret = PyObject_Call(meth, ptin, NULL);
-    Py_DECREF(meth);
-    Py_DECREF(ptin);
-
-    if (PyErr_Occurred())
+    else if (aMethodName == "done")
+      finish(false, "");
+    else if (aMethodName == "failed")
     {
-      if (ret != NULL)
-        Py_DECREF(ret);
-      *aWasException = true;
-      return cgs->makeVoid();
+      std::string why;
+      if (aInValues.size() == 1)
+      {
+        DECLARE_QUERY_INTERFACE_OBJREF(sv, aInValues[0], CGRS::StringValue);
+        if (sv != NULL)
+          why = sv->asString();
+      }
+      finish(true, why);
     }
-    *aWasException = false;
+    return sCGS->makeVoid();
+  }
 
-    RETURN_INTO_OBJREF(gtret, iface::CGRS::GenericType, gm->returnType());
-    if (!PyTuple_Check(ret))
-    {
-      iface::CGRS::GenericValue* gv = pythonToGenericValue(ret, gtret);
-      Py_DECREF(ret);
-      if (gv == NULL)
-        return cgs->makeVoid();
-      return gv;
-    }
+  // Waits, without the GIL, until done or failed has been called or aTimeout
+  // seconds have passed (never, if aTimeout is negative). Returns whether the
+  // run has finished.
+  bool wait(double aTimeout)
+  {
+    ScopedGILRelease release(true);
+    std::unique_lock<std::mutex> lock(mMutex);
+    if (aTimeout < 0)
+      mFinishedCondition.wait(lock, [this] { return mFinished; });
+    else
+      mFinishedCondition.wait_for(lock, std::chrono::duration<double>(aTimeout),
+                                  [this] { return mFinished; });
+    return mFinished;
+  }
 
-    PyObject* ret0 = PyTuple_GetItem(ret, 0);
-    iface::CGRS::GenericValue* gvret = pythonToGenericValue(ret0, gtret);
-    Py_DECREF(ret0);
-    std::vector<iface::CGRS::GenericParameter*> gvpar = gm->parameters();
+  bool finished()
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mFinished;
+  }
 
-    size_t outi = 1, anyi = 0;
-    for (; anyi < gvpar.size(); anyi++)
-    {
-      if (gvpar[anyi]->isOut())
-      {
-        PyObject* reti = PyTuple_GetItem(ret, outi++);
-        ObjRef<iface::CGRS::GenericType> gvtype(gvpar[anyi]->type());
-        aOutValues.push_back(pythonToGenericValue(reti, gvtype));
-        Py_DECREF(reti);
-      }
-      gvpar[anyi]->release_ref();
-    }
+  // Whether the run failed, and if so, why.
+  bool failed(std::string& aWhy)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    aWhy = mError;
+    return mFailed;
+  }
 
-    if (gvret == NULL)
-      return cgs->makeVoid();
-    return gvret;
+protected:
+  // Records one chunk of results, or finishes the run as failed if they
+  // cannot be stored. Called with mMutex held, until the run finishes.
+  virtual void appendResults(const std::vector<double>& aValues) = 0;
+
+  // Called with mMutex held when the run finishes, before waiters wake.
+  virtual void runFinished(bool)
+  {
+  }
+
+  // Finishes the run, unless it already has. Called with mMutex held, so that
+  // an observer can give up if it cannot store results.
+  void finishLocked(bool aFailed, const std::string& aWhy)
+  {
+    if (mFinished)
+      return;
+    runFinished(aFailed);
+    mFinished = true;
+    mFailed = aFailed;
+    mError = aWhy;
+    mFinishedCondition.notify_all();
   }
 
+  // Guards the recorded results and the completion state.
+  std::mutex mMutex;
+
 private:
-  PyObject* mPyObject;
-  int refcount;
+  void finish(bool aFailed, const std::string& aWhy)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    finishLocked(aFailed, aWhy);
+  }
+
+  std::atomic<int> refcount;
+  std::string mObjid;
+  std::condition_variable mFinishedCondition;
+  bool mFinished, mFailed;
+  std::string mError;
 };
 
-static PyTypeObject ObjectType = {
-    PyObject_HEAD_INIT(NULL)
-    0,                         /*ob_size*/
-    "cgrspy.Object",           /*tp_name*/
-    sizeof(Object),            /*tp_basicsize*/
-    0,                         /*tp_itemsize*/
-    (destructor)ObjectDealloc, /*tp_dealloc*/
-    0,                         /*tp_print*/
-    objectGetAttr,             /*tp_getattr*/
-    objectSetAttr,             /*tp_setattr*/
-    0,                         /*tp_compare*/
-    0,                         /*tp_repr*/
-    0,                         /*tp_as_number*/
-    0,                         /*tp_as_sequence*/
-    0,                         /*tp_as_mapping*/
-    0,                         /*tp_hash */
-    0,                         /*tp_call*/
-    0,                         /*tp_str*/
-    0,                         /*tp_getattro*/
-    0,                         /*tp_setattro*/
-    0,                         /*tp_as_buffer*/
-    Py_TPFLAGS_DEFAULT,        /*tp_flags*/
-    "A cgrspy wrapped CellML API Object", /* tp_doc */
-    0,		               /* tp_traverse */
-    0,		               /* tp_clear */
-    0,		               /* tp_richcompare */
-    0,		               /* tp_weaklistoffset */
-    objectGetIter,             /* tp_iter */
-    objectIterNext,            /* tp_iternext */
-    NULL,                      /* tp_methods */
+// Records results into one contiguous, row-major block of doubles, which grows
+// as needed or, if given a capacity, keeps only the latest rows as a ring.
+// Blocks are only freed while no buffer views of them exist, so a view stays
+// valid (if stale) after the block grows.
+class ResultRecorder
+  : public NativeObserver
+{
+public:
+  ResultRecorder(size_t aRowLength, size_t aCapacity)
+    : mRowLength(aRowLength), mRing(aCapacity != 0), mData(NULL), mCapacity(0),
+      mRows(0), mHead(0), mExports(0)
+  {
+  }
+
+  ~ResultRecorder()
+  {
+    free(mData);
+    for (std::vector<double*>::iterator i = mRetired.begin(); i != mRetired.end(); i++)
+      free(*i);
+    for (std::vector<Py_ssize_t*>::iterator i = mExportDims.begin(); i != mExportDims.end(); i++)
+      delete [] *i;
+  }
+
+  // Allocates the ring of aCapacity rows, for a recorder made with that
+  // capacity. Returns false if out of memory.
+  bool allocateRing(size_t aCapacity)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return reserve(aCapacity);
+  }
+
+  size_t rowLength()
+  {
+    return mRowLength;
+  }
+
+  size_t rows()
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mRows;
+  }
+
+  // Copies up to aMax elements of column aColumn into aOut, oldest row first.
+  // Returns the number copied.
+  size_t copyColumn(size_t aColumn, double* aOut, size_t aMax)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    size_t n = std::min(aMax, mRows);
+    for (size_t i = 0; i < n; i++)
+      aOut[i] = row(i)[aColumn];
+    return n;
+  }
+
+  // Copies row aRow (oldest first) into aOut. Returns false if there is no
+  // such row.
+  bool copyRow(size_t aRow, double* aOut)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (aRow >= mRows)
+      return false;
+    memcpy(aOut, row(aRow), mRowLength * sizeof(double));
+    return true;
+  }
+
+  // Returns the rows recorded so far, oldest first, as a block that stays
+  // allocated until every export has been released, or NULL if out of memory.
+  // With no rows and no block yet, it returns a placeholder.
+  // aDims is set to the shape and then the strides of the block, which live
+  // just as long; they can't be kept in the Py_buffer, since Python 2.7
+  // memoryviews copy their own view over the ones they export. Later results
+  // never change the rows exported: in ring mode, where they would overwrite
+  // them, the block is a snapshot.
+  double* exportRows(const Py_ssize_t*& aDims)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    double* data = mData;
+    if (mRing)
+    {
+      data = static_cast<double*>(malloc(mRows * mRowLength * sizeof(double) + 1));
+      if (data == NULL)
+        return NULL;
+      for (size_t i = 0; i < mRows; i++)
+        memcpy(data + i * mRowLength, row(i), mRowLength * sizeof(double));
+      mRetired.push_back(data);
+    }
+    else if (data == NULL)
+    {
+      static double sNoRows;
+      data = &sNoRows;
+    }
+    Py_ssize_t* dims = new Py_ssize_t[4];
+    dims[0] = mRows;
+    dims[1] = mRowLength;
+    dims[2] = mRowLength * sizeof(double);
+    dims[3] = sizeof(double);
+    mExportDims.push_back(dims);
+    mExports++;
+    aDims = dims;
+    return data;
+  }
+
+  void releaseExport()
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (--mExports != 0)
+      return;
+    for (std::vector<double*>::iterator i = mRetired.begin(); i != mRetired.end(); i++)
+      free(*i);
+    mRetired.clear();
+    for (std::vector<Py_ssize_t*>::iterator i = mExportDims.begin(); i != mExportDims.end(); i++)
+      delete [] *i;
+    mExportDims.clear();
+  }
+
+protected:
+  void appendResults(const std::vector<double>& aValues)
+  {
+    if (aValues.size() % mRowLength != 0)
+    {
+      finishLocked(true, "results are not a whole number of rows");
+      return;
+    }
+    size_t n = aValues.size() / mRowLength;
+    const double* src = aValues.data();
+    if (!mRing)
+    {
+      size_t doubled = mCapacity <= SIZE_MAX / 2 ? mCapacity * 2 : SIZE_MAX;
+      if (mRows + n > mCapacity && !reserve(std::max(mRows + n, std::max<size_t>(doubled, 64))))
+      {
+        finishLocked(true, "out of memory recording results");
+        return;
+      }
+      memcpy(mData + mRows * mRowLength, src, n * mRowLength * sizeof(double));
+      mRows += n;
+      return;
+    }
+
+    for (size_t i = 0; i < n; i++, src += mRowLength)
+    {
+      if (mRows < mCapacity)
+        memcpy(mData + ((mHead + mRows++) % mCapacity) * mRowLength, src, mRowLength * sizeof(double));
+      else
+      {
+        memcpy(mData + mHead * mRowLength, src, mRowLength * sizeof(double));
+        mHead = (mHead + 1) % mCapacity;
+      }
+    }
+  }
+
+private:
+  const double* row(size_t aRow)
+  {
+    return mData + ((mHead + aRow) % mCapacity) * mRowLength;
+  }
+
+  bool reserve(size_t aRows)
+  {
+    if (aRows > (SIZE_MAX - 1) / sizeof(double) / mRowLength)
+      return false;
+    double* data = static_cast<double*>(malloc(aRows * mRowLength * sizeof(double) + 1));
+    if (data == NULL)
+      return false;
+    if (mData != NULL)
+    {
+      memcpy(data, mData, mRows * mRowLength * sizeof(double));
+      if (mExports != 0)
+        mRetired.push_back(mData);
+      else
+        free(mData);
+    }
+    mData = data;
+    mCapacity = aRows;
+    return true;
+  }
+
+  const size_t mRowLength;
+  const bool mRing;
+  double* mData;
+  // The rows allocated, the rows recorded, and (in ring mode) the slot of the
+  // oldest row.
+  size_t mCapacity, mRows, mHead;
+  // The buffer views in use, and the blocks and dimensions they may still
+  // refer to.
+  size_t mExports;
+  std::vector<double*> mRetired;
+  std::vector<Py_ssize_t*> mExportDims;
+};
+
+// The layout of a columnar results file: a ColumnarHeader, a ColumnarColumn
+// describing each column, then (from dataOffset, which is page aligned) each
+// column as a contiguous array of rowCapacity doubles. Everything is in native
+// byte order. While the run is in progress rowCapacity may exceed rows; when
+// it finishes the columns are packed so that the two are equal, and only then,
+// once the file has its final size, is the status set to DONE or FAILED.
+struct ColumnarHeader
+{
+  char magic[8];
+  uint32_t version;
+  // One of the ColumnarStatus values.
+  uint32_t status;
+  uint64_t columnCount;
+  uint64_t rowCapacity;
+  uint64_t rows;
+  uint64_t dataOffset;
+  // The computation target counts that the columns were laid out from.
+  uint32_t rateCount;
+  uint32_t algebraicCount;
+};
+
+static const char kColumnarMagic[8] = {'C', 'G', 'R', 'S', 'C', 'O', 'L', '\n'};
+static const uint32_t kColumnarVersion = 1;
+
+enum ColumnarStatus
+{
+  COLUMNAR_RUNNING,
+  COLUMNAR_DONE,
+  COLUMNAR_FAILED
+};
+
+// What a column holds, in the order the integration service lays them out.
+enum ColumnKind
+{
+  COLUMN_UNKNOWN,
+  COLUMN_VARIABLE_OF_INTEGRATION,
+  COLUMN_STATE_VARIABLE,
+  COLUMN_RATE,
+  COLUMN_ALGEBRAIC
+};
+
+static const char* const sColumnKindNames[] = {
+  "UNKNOWN", "VARIABLE_OF_INTEGRATION", "STATE_VARIABLE", "RATE", "ALGEBRAIC"
+};
+
+struct ColumnarColumn
+{
+  uint32_t kind;
+  // The assigned index of the computation target.
+  int32_t index;
+  // The variable name, NUL terminated (and truncated if need be).
+  char name[56];
+};
+
+static uint64_t
+columnarDataOffset(uint64_t aColumnCount)
+{
+  uint64_t page = sysconf(_SC_PAGESIZE);
+  uint64_t end = sizeof(ColumnarHeader) + aColumnCount * sizeof(ColumnarColumn);
+  return (end + page - 1) / page * page;
+}
+
+// Sets aSize to the size of a columnar file with room for aRows rows, and
+// returns false if that is too large to map or to give to ftruncate.
+static bool
+columnarFileSize(uint64_t aDataOffset, uint64_t aColumnCount, uint64_t aRows, uint64_t& aSize)
+{
+  uint64_t limit = std::min<uint64_t>(SIZE_MAX, INT64_MAX);
+  if (aDataOffset > limit ||
+      (aColumnCount != 0 && aRows > (limit - aDataOffset) / sizeof(double) / aColumnCount))
+    return false;
+  aSize = aDataOffset + aColumnCount * aRows * sizeof(double);
+  return true;
+}
+
+// Streams results into a memory-mapped columnar file, without the GIL. The
+// file grows by doubling, moving the columns apart; pass the expected number
+// of rows to avoid that for long runs. Since the data moves and the file
+// shrinks when the run finishes, openColumnarFile refuses files still RUNNING.
+class ColumnarSink
+  : public NativeObserver
+{
+public:
+  ColumnarSink()
+    : mFd(-1), mMap(NULL), mMapSize(0), mHeader(NULL), mRows(0)
+  {
+  }
+
+  ~ColumnarSink()
+  {
+    close();
+  }
+
+  // Creates the file at aPath. Returns false, with the reason in aWhy, if it
+  // cannot.
+  bool open(const std::string& aPath, const ColumnarHeader& aHeader,
+            const std::vector<ColumnarColumn>& aColumns, uint64_t aExpectedRows, std::string& aWhy)
+  {
+    mPath = aPath;
+    uint64_t size;
+    if (!columnarFileSize(aHeader.dataOffset, aHeader.columnCount, aExpectedRows, size))
+    {
+      aWhy = aPath + ": " + strerror(EFBIG);
+      return false;
+    }
+    mFd = ::open(aPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (mFd == -1 || !map(size))
+    {
+      aWhy = aPath + ": " + strerror(errno);
+      close();
+      return false;
+    }
+
+    mHeader = reinterpret_cast<ColumnarHeader*>(mMap);
+    *mHeader = aHeader;
+    mHeader->rowCapacity = aExpectedRows;
+    memcpy(mMap + sizeof(ColumnarHeader), aColumns.data(), aColumns.size() * sizeof(ColumnarColumn));
+    return true;
+  }
+
+  const std::string& path()
+  {
+    return mPath;
+  }
+
+  uint64_t rows()
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mRows;
+  }
+
+protected:
+  void appendResults(const std::vector<double>& aValues)
+  {
+    if (mHeader == NULL)
+      return;
+
+    uint64_t columns = mHeader->columnCount, rows = mHeader->rows;
+    if (aValues.size() % columns != 0)
+    {
+      finishLocked(true, "results are not a whole number of rows");
+      return;
+    }
+    uint64_t n = aValues.size() / columns;
+    if (n > UINT64_MAX - rows)
+    {
+      finishLocked(true, mPath + ": " + strerror(EFBIG));
+      return;
+    }
+    if (rows + n > mHeader->rowCapacity)
+    {
+      // Double the capacity if we can, and otherwise grow it just enough.
+      uint64_t needed = rows + n, capacity = needed, size;
+      if (mHeader->rowCapacity <= UINT64_MAX / 2)
+        capacity = std::max(needed, mHeader->rowCapacity * 2);
+      if (!columnarFileSize(mHeader->dataOffset, columns, capacity, size))
+        capacity = needed;
+      if (!grow(capacity))
+      {
+        finishLocked(true, mPath + ": " + strerror(errno));
+        return;
+      }
+    }
+
+    const double* src = aValues.data();
+    for (uint64_t c = 0; c < columns; c++)
+    {
+      double* dst = column(c, mHeader->rowCapacity) + rows;
+      for (uint64_t r = 0; r < n; r++)
+        dst[r] = src[r * columns + c];
+    }
+    mHeader->rows = mRows = rows + n;
+  }
+
+  void runFinished(bool aFailed)
+  {
+    uint32_t status = aFailed ? COLUMNAR_FAILED : COLUMNAR_DONE;
+    if (mHeader == NULL)
+    {
+      // The file could not be remapped to grow it, but the header and the
+      // rows written before are intact.
+      if (mFd != -1 &&
+          pwrite(mFd, &status, sizeof(status), offsetof(ColumnarHeader, status)) != static_cast<ssize_t>(sizeof(status)))
+        errno = 0;
+      close();
+      return;
+    }
+
+    // Pack the columns and drop the unused space.
+    uint64_t rows = mHeader->rows;
+    for (uint64_t c = 1; c < mHeader->columnCount; c++)
+      memmove(column(c, rows), column(c, mHeader->rowCapacity), rows * sizeof(double));
+    mHeader->rowCapacity = rows;
+    uint64_t size = mHeader->dataOffset + mHeader->columnCount * rows * sizeof(double);
+    // A file that can't be shrunk is still readable, just larger than need be.
+    if (ftruncate(mFd, size) != 0)
+      errno = 0;
+    mHeader->status = status;
+    close();
+  }
+
+private:
+  double* column(uint64_t aColumn, uint64_t aCapacity)
+  {
+    return reinterpret_cast<double*>(mMap + mHeader->dataOffset) + aColumn * aCapacity;
+  }
+
+  // Sizes the file to aSize bytes and maps all of it.
+  bool map(uint64_t aSize)
+  {
+    if (mMap != NULL)
+      munmap(mMap, mMapSize);
+    mMap = NULL;
+    if (ftruncate(mFd, aSize) != 0)
+      return false;
+    void* m = mmap(NULL, aSize, PROT_READ | PROT_WRITE, MAP_SHARED, mFd, 0);
+    if (m == MAP_FAILED)
+      return false;
+    mMap = static_cast<char*>(m);
+    mMapSize = aSize;
+    return true;
+  }
+
+  bool grow(uint64_t aCapacity)
+  {
+    uint64_t oldCapacity = mHeader->rowCapacity, rows = mHeader->rows;
+    uint64_t dataOffset = mHeader->dataOffset, columns = mHeader->columnCount, size;
+    if (!columnarFileSize(dataOffset, columns, aCapacity, size))
+    {
+      errno = EFBIG;
+      return false;
+    }
+    if (!map(size))
+    {
+      mHeader = NULL;
+      return false;
+    }
+    mHeader = reinterpret_cast<ColumnarHeader*>(mMap);
+    // Columns only move up, so move the last one first.
+    for (uint64_t c = columns; c-- > 1;)
+      memmove(column(c, aCapacity), column(c, oldCapacity), rows * sizeof(double));
+    mHeader->rowCapacity = aCapacity;
+    return true;
+  }
+
+  void close()
+  {
+    if (mMap != NULL)
+      munmap(mMap, mMapSize);
+    if (mFd != -1)
+      ::close(mFd);
+    mMap = NULL;
+    mHeader = NULL;
+    mFd = -1;
+  }
+
+  std::string mPath;
+  int mFd;
+  char* mMap;
+  uint64_t mMapSize;
+  // The start of the mapping, or NULL once the file is closed.
+  ColumnarHeader* mHeader;
+  // The rows written, which stays readable after the file is closed.
+  uint64_t mRows;
+};
+
+static PyTypeObject ObjectType = {
+    PyObject_HEAD_INIT(NULL)
+    0,                         /*ob_size*/
+    "cgrspy.Object",           /*tp_name*/
+    sizeof(Object),            /*tp_basicsize*/
+    0,                         /*tp_itemsize*/
+    (destructor)ObjectDealloc, /*tp_dealloc*/
+    0,                         /*tp_print*/
+    objectGetAttr,             /*tp_getattr*/
+    objectSetAttr,             /*tp_setattr*/
+    0,                         /*tp_compare*/
+    0,                         /*tp_repr*/
+    0,                         /*tp_as_number*/
+    0,                         /*tp_as_sequence*/
+    0,                         /*tp_as_mapping*/
+    (hashfunc)objectHash,      /*tp_hash */
+    0,                         /*tp_call*/
+    0,                         /*tp_str*/
+    0,                         /*tp_getattro*/
+    0,                         /*tp_setattro*/
+    0,                         /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT,        /*tp_flags*/
+    "A cgrspy wrapped CellML API Object", /* tp_doc */
+    0,		               /* tp_traverse */
+    0,		               /* tp_clear */
+    objectRichCompare,         /* tp_richcompare */
+    0,		               /* tp_weaklistoffset */
+    objectGetIter,             /* tp_iter */
+    objectIterNext,            /* tp_iternext */
+    NULL,                      /* tp_methods */
     NULL,                      /* tp_members */
     0,                         /* tp_getset */
     0,                         /* tp_base */
@@ -388,7 +1289,7 @@ static PyTypeObject EnumType = {
     0,                         /*tp_call*/
     0,                         /*tp_str*/
     0,                         /*tp_getattro*/
-    0,                         /*tp_setattro*/
+    enumSetAttr,               /*tp_setattro*/
     0,                         /*tp_as_buffer*/
     Py_TPFLAGS_DEFAULT,        /*tp_flags*/
     "A cgrspy enum value",     /* tp_doc */
@@ -453,901 +1354,3703 @@ static PyTypeObject MethodType = {
     methodNew,                 /* tp_new */
 };
 
-static PyObject*
-genericValueToPythonB(iface::CGRS::GenericValue* aGenVal, const std::string& aTypename, iface::CGRS::GenericType* aGenType)
-{
-  if (aTypename == "boolean")
-  {
-    DECLARE_QUERY_INTERFACE_OBJREF(bv, aGenVal, CGRS::BooleanValue);
-    if (bv->asBoolean())
-    {
-      Py_RETURN_TRUE;
-    }
-    else
-    {
-      Py_RETURN_FALSE;
-    }
-  }
-
-  return NULL;
-}
+static PySequenceMethods NumericArray_as_sequence = {
+    (lenfunc)numericArrayLength,         /* sq_length */
+    (binaryfunc)numericArrayConcat,      /* sq_concat */
+    0,                                   /* sq_repeat */
+    (ssizeargfunc)numericArrayItem,      /* sq_item */
+    (ssizessizeargfunc)numericArraySlice, /* sq_slice */
+    0,                                   /* sq_ass_item */
+    0,                                   /* sq_ass_slice */
+    0                                    /* sq_contains */
+};
 
-static PyObject*
-genericValueToPythonC(iface::CGRS::GenericValue* aGenVal, const std::string& aTypename, iface::CGRS::GenericType* aGenType)
-{
-  if (aTypename == "char")
-  {
-    DECLARE_QUERY_INTERFACE_OBJREF(cv, aGenVal, CGRS::CharValue);
-    char v = cv->asChar();
-    return PyString_FromStringAndSize(&v, 1);
-  }
+static PyBufferProcs NumericArray_as_buffer = {
+    (readbufferproc)numericArrayGetReadBuffer,  /* bf_getreadbuffer */
+    (writebufferproc)numericArrayGetWriteBuffer, /* bf_getwritebuffer */
+    (segcountproc)numericArrayGetSegCount,      /* bf_getsegcount */
+    0,                                          /* bf_getcharbuffer */
+    (getbufferproc)numericArrayGetBuffer,       /* bf_getbuffer */
+    0                                           /* bf_releasebuffer */
+};
 
-  return NULL;
-}
+static PyMethodDef NumericArray_methods[] = {
+  {"tolist", (PyCFunction)numericArrayToList, METH_NOARGS,
+   "Convert the array to a list of Python numbers."},
+  {NULL}
+};
 
-static PyObject*
-genericValueToPythonD(iface::CGRS::GenericValue* aGenVal, const std::string& aTypename, iface::CGRS::GenericType* aGenType)
-{
-  if (aTypename == "double")
-  {
-    DECLARE_QUERY_INTERFACE_OBJREF(dv, aGenVal, CGRS::DoubleValue);
-    return PyFloat_FromDouble(dv->asDouble());
-  }
+static PyMemberDef NumericArray_members[] = {
+  {const_cast<char*>("typecode"), T_CHAR, offsetof(NumericArray, mFormat), READONLY,
+   const_cast<char*>("The struct module format character of the elements")},
+  {const_cast<char*>("itemsize"), T_PYSSIZET, offsetof(NumericArray, mItemSize), READONLY,
+   const_cast<char*>("The size of an element in bytes")},
+  {NULL}
+};
 
-  return NULL;
-}
+static PyTypeObject NumericArrayType = {
+    PyObject_HEAD_INIT(NULL)
+    0,                         /*ob_size*/
+    "cgrspy.NumericArray",     /*tp_name*/
+    sizeof(NumericArray),      /*tp_basicsize*/
+    0,                         /*tp_itemsize*/
+    (destructor)numericArrayDealloc, /*tp_dealloc*/
+    0,                         /*tp_print*/
+    0,                         /*tp_getattr*/
+    0,                         /*tp_setattr*/
+    0,                         /*tp_compare*/
+    0,                         /*tp_repr*/
+    0,                         /*tp_as_number*/
+    &NumericArray_as_sequence, /*tp_as_sequence*/
+    0,                         /*tp_as_mapping*/
+    0,                         /*tp_hash */
+    0,                         /*tp_call*/
+    0,                         /*tp_str*/
+    0,                         /*tp_getattro*/
+    0,                         /*tp_setattro*/
+    &NumericArray_as_buffer,   /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_NEWBUFFER, /*tp_flags*/
+    "A contiguous array of numbers from a CGRS sequence", /* tp_doc */
+    0,		               /* tp_traverse */
+    0,		               /* tp_clear */
+    0,		               /* tp_richcompare */
+    0,		               /* tp_weaklistoffset */
+    0,		               /* tp_iter */
+    0,		               /* tp_iternext */
+    NumericArray_methods,      /* tp_methods */
+    NumericArray_members,      /* tp_members */
+    0,                         /* tp_getset */
+    0,                         /* tp_base */
+    0,                         /* tp_dict */
+    0,                         /* tp_descr_get */
+    0,                         /* tp_descr_set */
+    0,                         /* tp_dictoffset */
+    0,                         /* tp_init */
+    0,                         /* tp_alloc */
+    0,                         /* tp_new */
+};
 
-static PyObject*
-genericValueToPythonF(iface::CGRS::GenericValue* aGenVal, const std::string& aTypename, iface::CGRS::GenericType* aGenType)
-{
-  if (aTypename == "float")
-  {
-    DECLARE_QUERY_INTERFACE_OBJREF(fv, aGenVal, CGRS::FloatValue);
-    return PyFloat_FromDouble(fv->asFloat());
-  }
+static PySequenceMethods Recorder_as_sequence = {
+    (lenfunc)recorderLength,             /* sq_length */
+    0,                                   /* sq_concat */
+    0,                                   /* sq_repeat */
+    (ssizeargfunc)recorderItem,          /* sq_item */
+    0,                                   /* sq_slice */
+    0,                                   /* sq_ass_item */
+    0,                                   /* sq_ass_slice */
+    0                                    /* sq_contains */
+};
 
-  return NULL;
-}
+static PyBufferProcs Recorder_as_buffer = {
+    0,                                          /* bf_getreadbuffer */
+    0,                                          /* bf_getwritebuffer */
+    0,                                          /* bf_getsegcount */
+    0,                                          /* bf_getcharbuffer */
+    (getbufferproc)recorderGetBuffer,           /* bf_getbuffer */
+    (releasebufferproc)recorderReleaseBuffer    /* bf_releasebuffer */
+};
 
-static PyObject*
-genericValueToPythonL(iface::CGRS::GenericValue* aGenVal, const std::string& aTypename, iface::CGRS::GenericType* aGenType)
-{
-  if (aTypename == "long")
-  {
-    DECLARE_QUERY_INTERFACE_OBJREF(lv, aGenVal, CGRS::LongValue);
-    return PyInt_FromLong(lv->asLong());
-  }
-  else if (aTypename == "long long")
-  {
-    DECLARE_QUERY_INTERFACE_OBJREF(llv, aGenVal, CGRS::LongLongValue);
-    return PyLong_FromLongLong(llv->asLongLong());
-  }
+static PyMethodDef Recorder_methods[] = {
+  {"wait", (PyCFunction)observerWait, METH_VARARGS,
+   "wait([timeout]): Wait, with the GIL released, for the run to finish; "
+   "return whether it has."},
+  {"column", (PyCFunction)recorderColumn, METH_VARARGS,
+   "column(index): Copy one column of the results into a NumericArray."},
+  {NULL}
+};
 
-  return NULL;
-}
+static PyGetSetDef Recorder_getset[] = {
+  {const_cast<char*>("rowLength"), (getter)recorderGetRowLength, NULL,
+   const_cast<char*>("The number of values in each row"), NULL},
+  {const_cast<char*>("finished"), (getter)observerGetFinished, NULL,
+   const_cast<char*>("Whether done or failed has been called"), NULL},
+  {const_cast<char*>("error"), (getter)observerGetError, NULL,
+   const_cast<char*>("The reason the run failed, or None"), NULL},
+  {NULL}
+};
 
-static PyObject*
-genericValueToPythonO(iface::CGRS::GenericValue* aGenVal, const std::string& aTypename, iface::CGRS::GenericType* aGenType)
-{
-  if (aTypename == "octet")
+static PyTypeObject RecorderType = {
+    PyObject_HEAD_INIT(NULL)
+    0,                         /*ob_size*/
+    "cgrspy.ResultRecorder",   /*tp_name*/
+    sizeof(Observer),          /*tp_basicsize*/
+    0,                         /*tp_itemsize*/
+    (destructor)observerDealloc, /*tp_dealloc*/
+    0,                         /*tp_print*/
+    0,                         /*tp_getattr*/
+    0,                         /*tp_setattr*/
+    0,                         /*tp_compare*/
+    0,                         /*tp_repr*/
+    0,                         /*tp_as_number*/
+    &Recorder_as_sequence,     /*tp_as_sequence*/
+    0,                         /*tp_as_mapping*/
+    0,                         /*tp_hash */
+    0,                         /*tp_call*/
+    0,                         /*tp_str*/
+    0,                         /*tp_getattro*/
+    0,                         /*tp_setattro*/
+    &Recorder_as_buffer,       /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_NEWBUFFER, /*tp_flags*/
+    "A native progress observer recording results as rows of doubles", /* tp_doc */
+    0,		               /* tp_traverse */
+    0,		               /* tp_clear */
+    0,		               /* tp_richcompare */
+    0,		               /* tp_weaklistoffset */
+    0,		               /* tp_iter */
+    0,		               /* tp_iternext */
+    Recorder_methods,          /* tp_methods */
+    NULL,                      /* tp_members */
+    Recorder_getset,           /* tp_getset */
+    0,                         /* tp_base */
+    0,                         /* tp_dict */
+    0,                         /* tp_descr_get */
+    0,                         /* tp_descr_set */
+    0,                         /* tp_dictoffset */
+    0,                         /* tp_init */
+    0,                         /* tp_alloc */
+    0,                         /* tp_new */
+};
+
+static PySequenceMethods ColumnarSink_as_sequence = {
+    (lenfunc)sinkLength,                 /* sq_length */
+    0,                                   /* sq_concat */
+    0,                                   /* sq_repeat */
+    0,                                   /* sq_item */
+    0,                                   /* sq_slice */
+    0,                                   /* sq_ass_item */
+    0,                                   /* sq_ass_slice */
+    0                                    /* sq_contains */
+};
+
+static PyMethodDef ColumnarSink_methods[] = {
+  {"wait", (PyCFunction)observerWait, METH_VARARGS,
+   "wait([timeout]): Wait, with the GIL released, for the run to finish and "
+   "the file to be closed; return whether it has."},
+  {NULL}
+};
+
+static PyGetSetDef ColumnarSink_getset[] = {
+  {const_cast<char*>("path"), (getter)sinkGetPath, NULL,
+   const_cast<char*>("The file the results are written to"), NULL},
+  {const_cast<char*>("finished"), (getter)observerGetFinished, NULL,
+   const_cast<char*>("Whether the run has finished and the file is closed"), NULL},
+  {const_cast<char*>("error"), (getter)observerGetError, NULL,
+   const_cast<char*>("The reason the run or the file failed, or None"), NULL},
+  {NULL}
+};
+
+static PyTypeObject ColumnarSinkType = {
+    PyObject_HEAD_INIT(NULL)
+    0,                         /*ob_size*/
+    "cgrspy.ColumnarSink",     /*tp_name*/
+    sizeof(Observer),          /*tp_basicsize*/
+    0,                         /*tp_itemsize*/
+    (destructor)observerDealloc, /*tp_dealloc*/
+    0,                         /*tp_print*/
+    0,                         /*tp_getattr*/
+    0,                         /*tp_setattr*/
+    0,                         /*tp_compare*/
+    0,                         /*tp_repr*/
+    0,                         /*tp_as_number*/
+    &ColumnarSink_as_sequence, /*tp_as_sequence*/
+    0,                         /*tp_as_mapping*/
+    0,                         /*tp_hash */
+    0,                         /*tp_call*/
+    0,                         /*tp_str*/
+    0,                         /*tp_getattro*/
+    0,                         /*tp_setattro*/
+    0,                         /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT,        /*tp_flags*/
+    "A native progress observer streaming results to a columnar file", /* tp_doc */
+    0,		               /* tp_traverse */
+    0,		               /* tp_clear */
+    0,		               /* tp_richcompare */
+    0,		               /* tp_weaklistoffset */
+    0,		               /* tp_iter */
+    0,		               /* tp_iternext */
+    ColumnarSink_methods,      /* tp_methods */
+    NULL,                      /* tp_members */
+    ColumnarSink_getset,       /* tp_getset */
+    0,                         /* tp_base */
+    0,                         /* tp_dict */
+    0,                         /* tp_descr_get */
+    0,                         /* tp_descr_set */
+    0,                         /* tp_dictoffset */
+    0,                         /* tp_init */
+    0,                         /* tp_alloc */
+    0,                         /* tp_new */
+};
+
+static PySequenceMethods ColumnarFile_as_sequence = {
+    (lenfunc)columnarFileLength,         /* sq_length */
+    0,                                   /* sq_concat */
+    0,                                   /* sq_repeat */
+    0,                                   /* sq_item */
+    0,                                   /* sq_slice */
+    0,                                   /* sq_ass_item */
+    0,                                   /* sq_ass_slice */
+    0                                    /* sq_contains */
+};
+
+static PyMethodDef ColumnarFile_methods[] = {
+  {"column", (PyCFunction)columnarFileColumn, METH_VARARGS,
+   "column(indexOrName): Return a column as a read-only NumericArray viewing "
+   "the file, without copying it."},
+  {NULL}
+};
+
+static PyMemberDef ColumnarFile_members[] = {
+  {const_cast<char*>("rateCount"), T_INT, offsetof(ColumnarFile, mRateCount), READONLY,
+   const_cast<char*>("The number of state variables (and rates) the columns were laid out for")},
+  {const_cast<char*>("algebraicCount"), T_INT, offsetof(ColumnarFile, mAlgebraicCount), READONLY,
+   const_cast<char*>("The number of algebraic variables the columns were laid out for")},
+  {NULL}
+};
+
+static PyGetSetDef ColumnarFile_getset[] = {
+  {const_cast<char*>("status"), (getter)columnarFileGetStatus, NULL,
+   const_cast<char*>("RUNNING, DONE or FAILED"), NULL},
+  {const_cast<char*>("names"), (getter)columnarFileGetNames, NULL,
+   const_cast<char*>("The variable name of each column, or '' if unknown"), NULL},
+  {const_cast<char*>("kinds"), (getter)columnarFileGetKinds, NULL,
+   const_cast<char*>("What each column holds, e.g. STATE_VARIABLE or RATE"), NULL},
+  {NULL}
+};
+
+static PyTypeObject ColumnarFileType = {
+    PyObject_HEAD_INIT(NULL)
+    0,                         /*ob_size*/
+    "cgrspy.ColumnarFile",     /*tp_name*/
+    sizeof(ColumnarFile),      /*tp_basicsize*/
+    0,                         /*tp_itemsize*/
+    (destructor)columnarFileDealloc, /*tp_dealloc*/
+    0,                         /*tp_print*/
+    0,                         /*tp_getattr*/
+    0,                         /*tp_setattr*/
+    0,                         /*tp_compare*/
+    0,                         /*tp_repr*/
+    0,                         /*tp_as_number*/
+    &ColumnarFile_as_sequence, /*tp_as_sequence*/
+    0,                         /*tp_as_mapping*/
+    0,                         /*tp_hash */
+    0,                         /*tp_call*/
+    0,                         /*tp_str*/
+    0,                         /*tp_getattro*/
+    0,                         /*tp_setattro*/
+    0,                         /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT,        /*tp_flags*/
+    "A columnar results file, mapped for reading", /* tp_doc */
+    0,		               /* tp_traverse */
+    0,		               /* tp_clear */
+    0,		               /* tp_richcompare */
+    0,		               /* tp_weaklistoffset */
+    0,		               /* tp_iter */
+    0,		               /* tp_iternext */
+    ColumnarFile_methods,      /* tp_methods */
+    ColumnarFile_members,      /* tp_members */
+    ColumnarFile_getset,       /* tp_getset */
+    0,                         /* tp_base */
+    0,                         /* tp_dict */
+    0,                         /* tp_descr_get */
+    0,                         /* tp_descr_set */
+    0,                         /* tp_dictoffset */
+    0,                         /* tp_init */
+    0,                         /* tp_alloc */
+    0,                         /* tp_new */
+};
+
+// Small integer tags for the CGRS types that the conversion functions
+// understand, so that converting a value is a single switch.
+enum TypeTag
+{
+  TYPE_UNKNOWN,
+  TYPE_VOID,
+  TYPE_BOOLEAN,
+  TYPE_CHAR,
+  TYPE_OCTET,
+  TYPE_SHORT,
+  TYPE_LONG,
+  TYPE_LONG_LONG,
+  TYPE_USHORT,
+  TYPE_ULONG,
+  TYPE_ULONG_LONG,
+  TYPE_FLOAT,
+  TYPE_DOUBLE,
+  TYPE_STRING,
+  TYPE_WSTRING,
+  TYPE_OBJECT,
+  TYPE_ENUM,
+  TYPE_SEQUENCE
+};
+
+static const struct
+{
+  const char* name;
+  TypeTag tag;
+} sBuiltinTypes[] = {
+  {"void", TYPE_VOID},
+  {"boolean", TYPE_BOOLEAN},
+  {"char", TYPE_CHAR},
+  {"octet", TYPE_OCTET},
+  {"short", TYPE_SHORT},
+  {"long", TYPE_LONG},
+  {"long long", TYPE_LONG_LONG},
+  {"unsigned short", TYPE_USHORT},
+  {"unsigned long", TYPE_ULONG},
+  {"unsigned long long", TYPE_ULONG_LONG},
+  {"float", TYPE_FLOAT},
+  {"double", TYPE_DOUBLE},
+  {"string", TYPE_STRING},
+  {"wstring", TYPE_WSTRING},
+  {"XPCOM::IObject", TYPE_OBJECT}
+};
+
+static TypeTag
+classifyType(iface::CGRS::GenericType* aType)
+{
+  std::string n = aType->asString();
+  for (size_t i = 0; i < sizeof(sBuiltinTypes) / sizeof(sBuiltinTypes[0]); i++)
+    if (n == sBuiltinTypes[i].name)
+      return sBuiltinTypes[i].tag;
+
+  DECLARE_QUERY_INTERFACE_OBJREF(et, aType, CGRS::EnumType);
+  if (et != NULL)
+    return TYPE_ENUM;
+
+  DECLARE_QUERY_INTERFACE_OBJREF(st, aType, CGRS::SequenceType);
+  if (st != NULL)
+    return TYPE_SEQUENCE;
+
+  return TYPE_UNKNOWN;
+}
+
+// Type tags cached by GenericType identity (only touched with the GIL held).
+// Each cached type is kept referenced so that its address cannot be reused by
+// a different type while it is in the cache. The cache is bounded in case a
+// CGRS implementation makes a fresh type object for every value.
+static std::unordered_map<iface::CGRS::GenericType*, TypeTag> sTypeTags;
+static const size_t kMaxTypeTags = 1024;
+
+static TypeTag
+typeTagOf(iface::CGRS::GenericType* aType)
+{
+  std::unordered_map<iface::CGRS::GenericType*, TypeTag>::iterator i = sTypeTags.find(aType);
+  if (i != sTypeTags.end())
+    return i->second;
+
+  if (sTypeTags.size() >= kMaxTypeTags)
+  {
+    for (i = sTypeTags.begin(); i != sTypeTags.end(); i++)
+      i->first->release_ref();
+    sTypeTags.clear();
+  }
+
+  TypeTag tag = classifyType(aType);
+  aType->add_ref();
+  sTypeTags[aType] = tag;
+  return tag;
+}
+
+// Statistics on crossings of the boundary, collected only while setStats has
+// turned them on, so that they cost a test of sStatsEnabled otherwise. Only
+// updated with the GIL held.
+static bool sStatsEnabled = false;
+
+// Latencies are counted in power-of-two buckets of nanoseconds; bucket b
+// counts calls taking at least 2**(b-1) and less than 2**b ns, and the last
+// also counts anything longer.
+static const int kLatencyBuckets = 40;
+
+// Counts and latencies of one kind of call to one member.
+struct CallStats
+{
+  CallStats()
+  {
+    reset();
+  }
+
+  void reset()
+  {
+    count = raised = totalNs = 0;
+    memset(buckets, 0, sizeof(buckets));
+  }
+
+  void record(uint64_t aStart, bool aRaised)
+  {
+    uint64_t elapsed = nowNs() - aStart;
+    int b = 0;
+    for (uint64_t e = elapsed; e != 0 && b < kLatencyBuckets - 1; e >>= 1)
+      b++;
+    count++;
+    if (aRaised)
+      raised++;
+    totalNs += elapsed;
+    buckets[b]++;
+  }
+
+  // A dict with the counts, and the histogram as (upper bound in ns, count)
+  // pairs for the buckets that are not empty.
+  PyObject* toPython() const
+  {
+    PyObject* histogram = PyList_New(0);
+    for (int b = 0; b < kLatencyBuckets; b++)
+    {
+      if (buckets[b] == 0)
+        continue;
+      PyObject* bucket = Py_BuildValue("(KK)", 1ULL << b, buckets[b]);
+      PyList_Append(histogram, bucket);
+      Py_DECREF(bucket);
+    }
+    return Py_BuildValue("{s:K,s:K,s:K,s:N}", "count", count, "raised", raised,
+                         "totalNs", totalNs, "histogram", histogram);
+  }
+
+  unsigned long long count, raised, totalNs;
+  unsigned long long buckets[kLatencyBuckets];
+};
+
+// The statistics of one member of one interface.
+struct MemberStats
+{
+  MemberStats()
+    : swallowed(0)
+  {
+  }
+
+  void reset()
+  {
+    getattr.reset();
+    setattr.reset();
+    call.reset();
+    callback.reset();
+    swallowed = 0;
+  }
+
+  CallStats getattr, setattr, call, callback;
+  // Exceptions from reflection caught (and ignored) while looking it up.
+  unsigned long long swallowed;
+};
+
+// Member statistics by interface name and then member name (empty for
+// lookups of the interface itself). Entries are reset but never freed, so
+// pointers to them remain valid.
+static std::unordered_map<std::string, std::unordered_map<std::string, MemberStats> > sMemberStats;
+
+static MemberStats*
+memberStats(const std::string& aInterfaceName, const std::string& aMemberName)
+{
+  return &sMemberStats[aInterfaceName][aMemberName];
+}
+
+// Names of traced members, "Interface::member", kept so that trace events can
+// point to them. Only used with the GIL held.
+static std::unordered_set<std::string> sTraceNames;
+
+static const char*
+traceName(const char*& aCached, const std::string& aInterfaceName, const std::string& aMemberName)
+{
+  if (aCached == NULL)
+    aCached = sTraceNames.insert(aInterfaceName + "::" + aMemberName).first->c_str();
+  return aCached;
+}
+
+// Notes an exception swallowed by a reflection lookup.
+static void
+noteSwallowed(const std::string& aInterfaceName, const std::string& aMemberName)
+{
+  if (sStatsEnabled)
+    memberStats(aInterfaceName, aMemberName)->swallowed++;
+}
+
+// Conversions by the tag of the type converted to or from; the first row is
+// for conversions to Python, the second for conversions to CGRS.
+static unsigned long long sConversions[2][TYPE_SEQUENCE + 1];
+
+static const char*
+typeTagName(TypeTag aTag)
+{
+  for (size_t i = 0; i < sizeof(sBuiltinTypes) / sizeof(sBuiltinTypes[0]); i++)
+    if (sBuiltinTypes[i].tag == aTag)
+      return sBuiltinTypes[i].name;
+  switch (aTag)
+  {
+  case TYPE_ENUM:
+    return "enum";
+  case TYPE_SEQUENCE:
+    return "sequence";
+  default:
+    return "unknown";
+  }
+}
+
+static PyObject*
+conversionStats(int aDirection)
+{
+  PyObject* d = PyDict_New();
+  for (int t = 0; t <= TYPE_SEQUENCE; t++)
+  {
+    if (sConversions[aDirection][t] == 0)
+      continue;
+    PyObject* n = PyLong_FromUnsignedLongLong(sConversions[aDirection][t]);
+    PyDict_SetItemString(d, typeTagName(static_cast<TypeTag>(t)), n);
+    Py_DECREF(n);
+  }
+  return d;
+}
+
+static PyObject* genericValueToPython(iface::CGRS::GenericValue* aGenVal, iface::CGRS::GenericType* aType,
+                                      TypeTag aTag);
+static already_AddRefd<iface::CGRS::GenericValue> pythonToGenericValue(PyObject* aObj, iface::CGRS::GenericType* aType,
+                                                                       TypeTag aTag);
+
+// Short string results, interned so that repeated names and identifiers share
+// one object, which is also the one Python's intern table (and so any string
+// literal) uses. Off unless setStringInterning turns it on; bounded, and only
+// used with the GIL held.
+static size_t sInternMaxLength = 0;
+static size_t sInternCapacity = 4096;
+static std::unordered_map<std::string, PyObject*> sInternedStrings;
+
+static void
+clearInternedStrings()
+{
+  for (std::unordered_map<std::string, PyObject*>::iterator i = sInternedStrings.begin();
+       i != sInternedStrings.end(); i++)
+    Py_DECREF(i->second);
+  sInternedStrings.clear();
+}
+
+static bool
+internable(size_t aLength)
+{
+  return sInternMaxLength != 0 && aLength <= sInternMaxLength;
+}
+
+// Returns a str holding aValue, which is shared with earlier results if it is
+// short enough to be interned.
+static PyObject*
+stringToPython(const std::string& aValue)
+{
+  if (!internable(aValue.size()))
+    return PyString_FromStringAndSize(aValue.data(), aValue.size());
+
+  std::unordered_map<std::string, PyObject*>::iterator i = sInternedStrings.find(aValue);
+  if (i != sInternedStrings.end())
+  {
+    Py_INCREF(i->second);
+    return i->second;
+  }
+
+  PyObject* str = PyString_FromStringAndSize(aValue.data(), aValue.size());
+  if (str == NULL)
+    return NULL;
+  PyString_InternInPlace(&str);
+  if (sInternedStrings.size() >= sInternCapacity)
+    clearInternedStrings();
+  Py_INCREF(str);
+  sInternedStrings[aValue] = str;
+  return str;
+}
+
+// Converts a wide string to a str if it is ASCII, as most names and
+// identifiers are, so that such results are unchanged, and otherwise to
+// unicode, in the same way as the xml modules. Either way the characters are
+// copied once, straight from the wstring.
+static PyObject*
+genericValueToPythonW(iface::CGRS::GenericValue* aGenVal)
+{
+  DECLARE_QUERY_INTERFACE_OBJREF(wsv, aGenVal, CGRS::WStringValue);
+  std::wstring ws(wsv->asWString());
+  const wchar_t* w = ws.data();
+  size_t n = ws.size(), i = 0;
+  while (i < n && static_cast<uint32_t>(w[i]) < 0x80)
+    i++;
+
+  if (i == n && internable(n))
+    return stringToPython(std::string(ws.begin(), ws.end()));
+
+  if (i == n)
+  {
+    PyObject* str = PyString_FromStringAndSize(NULL, n);
+    if (str == NULL)
+      return NULL;
+    char* d = PyString_AS_STRING(str);
+    for (i = 0; i < n; i++)
+      d[i] = static_cast<char>(w[i]);
+    return str;
+  }
+
+#if Py_UNICODE_SIZE == SIZEOF_WCHAR_T
+  return PyUnicode_FromUnicode(reinterpret_cast<const Py_UNICODE*>(w), n);
+#else
+  // A UCS-2 Python with a 32 bit wchar_t: characters outside the BMP become
+  // surrogate pairs.
+  size_t extra = 0;
+  for (i = 0; i < n; i++)
+    if (static_cast<uint32_t>(w[i]) > 0xFFFF)
+      extra++;
+  PyObject* u = PyUnicode_FromUnicode(NULL, n + extra);
+  if (u == NULL)
+    return NULL;
+  Py_UNICODE* d = PyUnicode_AS_UNICODE(u);
+  for (i = 0; i < n; i++)
+  {
+    uint32_t c = w[i];
+    if (c > 0xFFFF)
+    {
+      c -= 0x10000;
+      *d++ = 0xD800 | (c >> 10);
+      *d++ = 0xDC00 | (c & 0x3FF);
+    }
+    else
+      *d++ = c;
+  }
+  return u;
+#endif
+}
+
+// Whether numeric sequences are returned as NumericArrays rather than lists.
+static bool sNumericArrays = false;
+
+template<class V, class T> static PyObject*
+sequenceToNumericArray(iface::CGRS::SequenceValue* aSeq, char aFormat,
+                       const char* aIfaceName, T (V::*aGetter)())
+{
+  Py_ssize_t l = aSeq->valueCount();
+  NumericArray* arr = numericArrayNew(aFormat, sizeof(T), l);
+  if (arr == NULL)
+    return NULL;
+
+  T* data = reinterpret_cast<T*>(arr->mData);
+  for (Py_ssize_t i = 0; i < l; i++)
+  {
+    ObjRef<iface::CGRS::GenericValue> svi(aSeq->getValueByIndex(i));
+    V* v = reinterpret_cast<V*>(svi->query_interface(aIfaceName));
+    if (v == NULL)
+    {
+      // Not what the sequence type said; let the caller build a list.
+      Py_DECREF(arr);
+      return NULL;
+    }
+    data[i] = (v->*aGetter)();
+    v->release_ref();
+  }
+  return (PyObject*)arr;
+}
+
+// Returns NULL without an exception set if the sequence isn't numeric.
+static PyObject*
+genericValueToNumericArray(iface::CGRS::SequenceValue* aSeq, iface::CGRS::GenericType* aGenType)
+{
+  DECLARE_QUERY_INTERFACE_OBJREF(st, aGenType, CGRS::SequenceType);
+  if (st == NULL)
+    return NULL;
+  ObjRef<iface::CGRS::GenericType> innerType(st->innerType());
+
+  switch (typeTagOf(innerType))
+  {
+  case TYPE_DOUBLE:
+    return sequenceToNumericArray(aSeq, 'd', "CGRS::DoubleValue", &iface::CGRS::DoubleValue::asDouble);
+  case TYPE_FLOAT:
+    return sequenceToNumericArray(aSeq, 'f', "CGRS::FloatValue", &iface::CGRS::FloatValue::asFloat);
+  case TYPE_OCTET:
+    return sequenceToNumericArray(aSeq, 'B', "CGRS::OctetValue", &iface::CGRS::OctetValue::asOctet);
+  case TYPE_SHORT:
+    return sequenceToNumericArray(aSeq, 'h', "CGRS::ShortValue", &iface::CGRS::ShortValue::asShort);
+  case TYPE_USHORT:
+    return sequenceToNumericArray(aSeq, 'H', "CGRS::UShortValue", &iface::CGRS::UShortValue::asUShort);
+  case TYPE_LONG:
+    return sequenceToNumericArray(aSeq, 'i', "CGRS::LongValue", &iface::CGRS::LongValue::asLong);
+  case TYPE_ULONG:
+    return sequenceToNumericArray(aSeq, 'I', "CGRS::ULongValue", &iface::CGRS::ULongValue::asULong);
+  case TYPE_LONG_LONG:
+    return sequenceToNumericArray(aSeq, 'q', "CGRS::LongLongValue", &iface::CGRS::LongLongValue::asLongLong);
+  case TYPE_ULONG_LONG:
+    return sequenceToNumericArray(aSeq, 'Q', "CGRS::ULongLongValue", &iface::CGRS::ULongLongValue::asULongLong);
+  default:
+    return NULL;
+  }
+}
+
+static PyObject*
+genericValueToPythonSequence(iface::CGRS::GenericValue* aGenVal, iface::CGRS::GenericType* aGenType)
+{
+  DECLARE_QUERY_INTERFACE_OBJREF(sv, aGenVal, CGRS::SequenceValue);
+  if (sv == NULL)
+    return NULL;
+
+  if (sNumericArrays)
+  {
+    PyObject* arr = genericValueToNumericArray(sv, aGenType);
+    if (arr != NULL || PyErr_Occurred())
+      return arr;
+  }
+
+  long l = sv->valueCount();
+  PyObject* lst = PyList_New(l);
+  for (long i = 0; i < l; i++)
+  {
+    ObjRef<iface::CGRS::GenericValue> svi(sv->getValueByIndex(i));
+    PyList_SET_ITEM(lst, i, genericValueToPython(svi));
+  }
+  return lst;
+}
+
+// A bounded list of deallocated objects of one type, kept for reuse in the
+// same way as CPython's float and tuple free-lists. Only used with the GIL
+// held. Free objects are chained through their ob_type field.
+template<class T> class FreeList
+{
+public:
+  FreeList(PyTypeObject* aType)
+    : mType(aType), mFree(NULL), mFreeCount(0), mAllocated(0), mReused(0)
+  {
+  }
+
+  T* alloc()
+  {
+    if (mFree == NULL)
+    {
+      mAllocated++;
+      return PyObject_New(T, mType);
+    }
+
+    T* obj = mFree;
+    mFree = reinterpret_cast<T*>(Py_TYPE(obj));
+    mFreeCount--;
+    mReused++;
+    return PyObject_INIT(obj, mType);
+  }
+
+  void release(T* aObj)
+  {
+    if (mFreeCount >= kMaxFree)
+    {
+      mType->tp_free(reinterpret_cast<PyObject*>(aObj));
+      return;
+    }
+
+    Py_TYPE(aObj) = reinterpret_cast<PyTypeObject*>(mFree);
+    mFree = aObj;
+    mFreeCount++;
+  }
+
+  PyObject* stats()
+  {
+    return Py_BuildValue("{s:k,s:k,s:n}", "allocated", mAllocated, "reused", mReused,
+                         "free", mFreeCount);
+  }
+
+  void resetStats()
+  {
+    mAllocated = mReused = 0;
+  }
+
+private:
+  static const Py_ssize_t kMaxFree = 256;
+
+  PyTypeObject* mType;
+  T* mFree;
+  Py_ssize_t mFreeCount;
+  unsigned long mAllocated, mReused;
+};
+
+static FreeList<Object> sFreeObjects(&ObjectType);
+static FreeList<Method> sFreeMethods(&MethodType);
+static FreeList<Enum> sFreeEnums(&EnumType);
+
+// The live wrapper of each native object, so that a native object is always
+// represented by the same Python object. The wrappers are not referenced
+// here; each removes itself when it is deallocated. Only used with the GIL
+// held.
+static std::unordered_map<iface::XPCOM::IObject*, Object*> sWrappers;
+
+static void
+ObjectDealloc(Object* self)
+{
+  if (self->mObject != NULL)
+  {
+    sWrappers.erase(self->mObject);
+    self->mObject->release_ref();
+  }
+  if (self->mObjectValue != NULL)
+    self->mObjectValue->release_ref();
+  Py_XDECREF(self->mPrefetched);
+  Py_XDECREF(self->mPrefetchErrorType);
+  Py_XDECREF(self->mPrefetchErrorValue);
+  Py_XDECREF(self->mPrefetchErrorTraceback);
+  sFreeObjects.release(self);
+}
+
+static PyObject* Object_new(iface::XPCOM::IObject* aValue)
+{
+  Object*& wrapper = sWrappers[aValue];
+  if (wrapper != NULL)
+  {
+    Py_INCREF(wrapper);
+    return (PyObject*)wrapper;
+  }
+
+  Object* obj = sFreeObjects.alloc();
+  wrapper = obj;
+  obj->mObject = aValue;
+  obj->mObject->add_ref();
+  obj->mObjectValue = NULL;
+  obj->mInterfaceSet = NULL;
+  obj->mPrefetched = NULL;
+  obj->mPrefetchPos = 0;
+  obj->mPrefetchErrorType = NULL;
+  obj->mPrefetchErrorValue = NULL;
+  obj->mPrefetchErrorTraceback = NULL;
+
+  return (PyObject*)obj;
+}
+
+static long
+objectHash(Object* self)
+{
+  return _Py_HashPointer(self->mObject);
+}
+
+static PyObject*
+objectRichCompare(PyObject* aA, PyObject* aB, int aOp)
+{
+  if (!PyObject_TypeCheck(aA, &ObjectType) || !PyObject_TypeCheck(aB, &ObjectType) ||
+      (aOp != Py_EQ && aOp != Py_NE))
+  {
+    Py_INCREF(Py_NotImplemented);
+    return Py_NotImplemented;
+  }
+
+  bool same = reinterpret_cast<Object*>(aA)->mObject == reinterpret_cast<Object*>(aB)->mObject;
+  PyObject* ret = (same == (aOp == Py_EQ)) ? Py_True : Py_False;
+  Py_INCREF(ret);
+  return ret;
+}
+
+static void EnumDealloc(Enum* self)
+{
+  Py_CLEAR(self->asString);
+  sFreeEnums.release(self);
+}
+
+static int EnumInit(Enum *self, PyObject *args, PyObject *kwds)
+{
+  PyObject *asString = Py_None;
+
+  static const char *kwlist[] = {"asString", "asInteger", NULL};
+
+  if (self->mInterned)
+  {
+    PyErr_SetString(PyExc_TypeError, "Enum values returned by native code cannot be changed");
+    return -1;
+  }
+
+  if (! PyArg_ParseTupleAndKeywords(args, kwds, "|Si", const_cast<char**>(kwlist), 
+                                    &asString,
+                                    &self->asInteger))
+    return -1; 
+
+  Py_INCREF(asString);
+  Py_XDECREF(self->asString);
+  self->asString = asString;
+  return 0;
+}
+
+static int
+enumSetAttr(PyObject* aObj, PyObject* aName, PyObject* aValue)
+{
+  if (reinterpret_cast<Enum*>(aObj)->mInterned)
+  {
+    PyErr_SetString(PyExc_TypeError, "Enum values returned by native code cannot be changed");
+    return -1;
+  }
+  return PyObject_GenericSetAttr(aObj, aName, aValue);
+}
+
+static PyObject *EnumNew(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+  Enum *self;
+
+  self = (Enum*)type->tp_alloc(type, 0);
+  if (self != NULL)
+  {
+    self->asString = Py_None;
+    Py_INCREF(self->asString);
+    self->asInteger = -1;
+    self->mInterned = 0;
+  }
+  
+  return (PyObject *)self;
+}
+
+static NumericArray*
+numericArrayNew(char aFormat, Py_ssize_t aItemSize, Py_ssize_t aLength)
+{
+  NumericArray* arr = PyObject_New(NumericArray, &NumericArrayType);
+  if (arr == NULL)
+    return NULL;
+
+  arr->mData = reinterpret_cast<char*>(PyMem_Malloc(aLength * aItemSize + 1));
+  arr->mLength = aLength;
+  arr->mItemSize = aItemSize;
+  arr->mFormat[0] = aFormat;
+  arr->mFormat[1] = 0;
+  arr->mOwner = NULL;
+  if (arr->mData == NULL)
+  {
+    Py_DECREF(arr);
+    PyErr_NoMemory();
+    return NULL;
+  }
+  return arr;
+}
+
+// Makes a read-only array of aLength elements at aData, which belongs to (and
+// lives as long as) aOwner.
+static NumericArray*
+numericArrayView(PyObject* aOwner, char aFormat, Py_ssize_t aItemSize, char* aData, Py_ssize_t aLength)
+{
+  NumericArray* arr = PyObject_New(NumericArray, &NumericArrayType);
+  if (arr == NULL)
+    return NULL;
+
+  arr->mData = aData;
+  arr->mLength = aLength;
+  arr->mItemSize = aItemSize;
+  arr->mFormat[0] = aFormat;
+  arr->mFormat[1] = 0;
+  arr->mOwner = aOwner;
+  Py_INCREF(aOwner);
+  return arr;
+}
+
+static void
+numericArrayDealloc(NumericArray* self)
+{
+  if (self->mOwner != NULL)
+    Py_DECREF(self->mOwner);
+  else
+    PyMem_Free(self->mData);
+  self->ob_type->tp_free((PyObject*)self);
+}
+
+static Py_ssize_t
+numericArrayLength(NumericArray* self)
+{
+  return self->mLength;
+}
+
+static PyObject*
+numericArrayItem(NumericArray* self, Py_ssize_t aIndex)
+{
+  if (aIndex < 0 || aIndex >= self->mLength)
+  {
+    PyErr_SetString(PyExc_IndexError, "NumericArray index out of range");
+    return NULL;
+  }
+
+  char* p = self->mData + aIndex * self->mItemSize;
+  switch (self->mFormat[0])
+  {
+  case 'd':
+    return PyFloat_FromDouble(*reinterpret_cast<double*>(p));
+  case 'f':
+    return PyFloat_FromDouble(*reinterpret_cast<float*>(p));
+  case 'B':
+    return PyInt_FromLong(*reinterpret_cast<uint8_t*>(p));
+  case 'h':
+    return PyInt_FromLong(*reinterpret_cast<int16_t*>(p));
+  case 'H':
+    return PyInt_FromLong(*reinterpret_cast<uint16_t*>(p));
+  case 'i':
+    return PyInt_FromLong(*reinterpret_cast<int32_t*>(p));
+  case 'I':
+    return PyLong_FromUnsignedLong(*reinterpret_cast<uint32_t*>(p));
+  case 'q':
+    return PyLong_FromLongLong(*reinterpret_cast<int64_t*>(p));
+  case 'Q':
+    return PyLong_FromUnsignedLongLong(*reinterpret_cast<uint64_t*>(p));
+  }
+
+  PyErr_SetString(PyExc_TypeError, "NumericArray has an unknown element type");
+  return NULL;
+}
+
+static PyObject*
+numericArraySlice(NumericArray* self, Py_ssize_t aLow, Py_ssize_t aHigh)
+{
+  if (aLow < 0)
+    aLow = 0;
+  if (aHigh > self->mLength)
+    aHigh = self->mLength;
+  if (aHigh < aLow)
+    aHigh = aLow;
+
+  NumericArray* arr = numericArrayNew(self->mFormat[0], self->mItemSize, aHigh - aLow);
+  if (arr == NULL)
+    return NULL;
+  memcpy(arr->mData, self->mData + aLow * self->mItemSize, (aHigh - aLow) * self->mItemSize);
+  return (PyObject*)arr;
+}
+
+static PyObject*
+numericArrayConcat(NumericArray* self, PyObject* aOther)
+{
+  if (Py_TYPE(aOther) != &NumericArrayType ||
+      reinterpret_cast<NumericArray*>(aOther)->mFormat[0] != self->mFormat[0])
+  {
+    PyErr_SetString(PyExc_TypeError, "Can only concatenate a NumericArray to one of the same type");
+    return NULL;
+  }
+
+  NumericArray* other = reinterpret_cast<NumericArray*>(aOther);
+  NumericArray* arr = numericArrayNew(self->mFormat[0], self->mItemSize, self->mLength + other->mLength);
+  if (arr == NULL)
+    return NULL;
+  memcpy(arr->mData, self->mData, self->mLength * self->mItemSize);
+  memcpy(arr->mData + self->mLength * self->mItemSize, other->mData, other->mLength * other->mItemSize);
+  return (PyObject*)arr;
+}
+
+static PyObject*
+numericArrayToList(NumericArray* self)
+{
+  PyObject* lst = PyList_New(self->mLength);
+  if (lst == NULL)
+    return NULL;
+  for (Py_ssize_t i = 0; i < self->mLength; i++)
+  {
+    PyObject* item = numericArrayItem(self, i);
+    if (item == NULL)
+    {
+      Py_DECREF(lst);
+      return NULL;
+    }
+    PyList_SET_ITEM(lst, i, item);
+  }
+  return lst;
+}
+
+static int
+numericArrayGetBuffer(NumericArray* self, Py_buffer* aView, int aFlags)
+{
+  if ((aFlags & PyBUF_WRITABLE) && self->mOwner != NULL)
+  {
+    PyErr_SetString(PyExc_BufferError, "NumericArray is a read-only view");
+    return -1;
+  }
+
+  aView->buf = self->mData;
+  aView->obj = (PyObject*)self;
+  Py_INCREF(self);
+  aView->len = self->mLength * self->mItemSize;
+  aView->readonly = self->mOwner != NULL;
+  aView->itemsize = self->mItemSize;
+  aView->format = (aFlags & PyBUF_FORMAT) ? self->mFormat : NULL;
+  aView->ndim = 1;
+  aView->shape = (aFlags & PyBUF_ND) ? &self->mLength : NULL;
+  aView->strides = (aFlags & PyBUF_STRIDES) == PyBUF_STRIDES ? &self->mItemSize : NULL;
+  aView->suboffsets = NULL;
+  aView->internal = NULL;
+  return 0;
+}
+
+static Py_ssize_t
+numericArrayGetReadBuffer(NumericArray* self, Py_ssize_t aSegment, void** aPtr)
+{
+  if (aSegment != 0)
+  {
+    PyErr_SetString(PyExc_SystemError, "Accessing a non-existent NumericArray segment");
+    return -1;
+  }
+  *aPtr = self->mData;
+  return self->mLength * self->mItemSize;
+}
+
+static Py_ssize_t
+numericArrayGetWriteBuffer(NumericArray* self, Py_ssize_t aSegment, void** aPtr)
+{
+  if (self->mOwner != NULL)
+  {
+    PyErr_SetString(PyExc_TypeError, "NumericArray is a read-only view");
+    return -1;
+  }
+  return numericArrayGetReadBuffer(self, aSegment, aPtr);
+}
+
+static Py_ssize_t
+numericArrayGetSegCount(NumericArray* self, Py_ssize_t* aLength)
+{
+  if (aLength != NULL)
+    *aLength = self->mLength * self->mItemSize;
+  return 1;
+}
+
+static void
+observerDealloc(Observer* self)
+{
+  self->mObserver->release_ref();
+  self->ob_type->tp_free((PyObject*)self);
+}
+
+static ResultRecorder*
+recorderOf(Observer* aObserver)
+{
+  return static_cast<ResultRecorder*>(aObserver->mObserver);
+}
+
+static Py_ssize_t
+recorderLength(Observer* self)
+{
+  return recorderOf(self)->rows();
+}
+
+static PyObject*
+recorderItem(Observer* self, Py_ssize_t aIndex)
+{
+  NumericArray* arr = numericArrayNew('d', sizeof(double), recorderOf(self)->rowLength());
+  if (arr == NULL)
+    return NULL;
+  if (aIndex < 0 || !recorderOf(self)->copyRow(aIndex, reinterpret_cast<double*>(arr->mData)))
+  {
+    Py_DECREF(arr);
+    PyErr_SetString(PyExc_IndexError, "ResultRecorder row out of range");
+    return NULL;
+  }
+  return (PyObject*)arr;
+}
+
+static PyObject*
+observerWait(Observer* self, PyObject* args)
+{
+  PyObject* timeout = Py_None;
+  if (!PyArg_ParseTuple(args, "|O", &timeout))
+    return NULL;
+  double t = -1;
+  if (timeout != Py_None)
+  {
+    t = PyFloat_AsDouble(timeout);
+    if (t == -1 && PyErr_Occurred())
+      return NULL;
+    if (t < 0)
+      t = 0;
+  }
+  return PyBool_FromLong(self->mObserver->wait(t));
+}
+
+static PyObject*
+recorderColumn(Observer* self, PyObject* args)
+{
+  Py_ssize_t column;
+  if (!PyArg_ParseTuple(args, "n", &column))
+    return NULL;
+  if (column < 0 || static_cast<size_t>(column) >= recorderOf(self)->rowLength())
+  {
+    PyErr_SetString(PyExc_IndexError, "ResultRecorder column out of range");
+    return NULL;
+  }
+
+  size_t rows = recorderOf(self)->rows();
+  NumericArray* arr = numericArrayNew('d', sizeof(double), rows);
+  if (arr == NULL)
+    return NULL;
+  arr->mLength = recorderOf(self)->copyColumn(column, reinterpret_cast<double*>(arr->mData), rows);
+  return (PyObject*)arr;
+}
+
+static PyObject*
+recorderGetRowLength(Observer* self, void* aClosure)
+{
+  return PyInt_FromSize_t(recorderOf(self)->rowLength());
+}
+
+static PyObject*
+observerGetFinished(Observer* self, void* aClosure)
+{
+  return PyBool_FromLong(self->mObserver->finished());
+}
+
+static PyObject*
+observerGetError(Observer* self, void* aClosure)
+{
+  std::string why;
+  if (!self->mObserver->failed(why))
+  {
+    Py_RETURN_NONE;
+  }
+  return PyString_FromStringAndSize(why.data(), why.size());
+}
+
+// Exports the rows recorded so far as a read-only rows x rowLength array.
+static int
+recorderGetBuffer(Observer* self, Py_buffer* aView, int aFlags)
+{
+  if (aFlags & PyBUF_WRITABLE)
+  {
+    PyErr_SetString(PyExc_BufferError, "ResultRecorder buffers are read-only");
+    return -1;
+  }
+
+  const Py_ssize_t* dims;
+  aView->buf = recorderOf(self)->exportRows(dims);
+  if (aView->buf == NULL)
+  {
+    PyErr_NoMemory();
+    return -1;
+  }
+  aView->obj = (PyObject*)self;
+  Py_INCREF(self);
+  aView->len = dims[0] * dims[2];
+  aView->readonly = 1;
+  aView->itemsize = sizeof(double);
+  aView->format = (aFlags & PyBUF_FORMAT) ? const_cast<char*>("d") : NULL;
+  aView->ndim = 2;
+  aView->shape = (aFlags & PyBUF_ND) ? const_cast<Py_ssize_t*>(dims) : NULL;
+  aView->strides = (aFlags & PyBUF_STRIDES) == PyBUF_STRIDES ? const_cast<Py_ssize_t*>(dims + 2) : NULL;
+  aView->suboffsets = NULL;
+  aView->internal = NULL;
+  return 0;
+}
+
+static void
+recorderReleaseBuffer(Observer* self, Py_buffer* aView)
+{
+  recorderOf(self)->releaseExport();
+}
+
+static ColumnarSink*
+sinkOf(Observer* aObserver)
+{
+  return static_cast<ColumnarSink*>(aObserver->mObserver);
+}
+
+static Py_ssize_t
+sinkLength(Observer* self)
+{
+  return sinkOf(self)->rows();
+}
+
+static PyObject*
+sinkGetPath(Observer* self, void* aClosure)
+{
+  const std::string& path = sinkOf(self)->path();
+  return PyString_FromStringAndSize(path.data(), path.size());
+}
+
+static const ColumnarHeader*
+columnarHeader(ColumnarFile* aFile)
+{
+  return reinterpret_cast<const ColumnarHeader*>(aFile->mMap);
+}
+
+static const ColumnarColumn*
+columnarColumns(ColumnarFile* aFile)
+{
+  return reinterpret_cast<const ColumnarColumn*>(aFile->mMap + sizeof(ColumnarHeader));
+}
+
+static void
+columnarFileDealloc(ColumnarFile* self)
+{
+  munmap(self->mMap, self->mMapSize);
+  self->ob_type->tp_free((PyObject*)self);
+}
+
+static Py_ssize_t
+columnarFileLength(ColumnarFile* self)
+{
+  return self->mRows;
+}
+
+static PyObject*
+columnarFileColumn(ColumnarFile* self, PyObject* args)
+{
+  PyObject* which;
+  if (!PyArg_ParseTuple(args, "O", &which))
+    return NULL;
+
+  Py_ssize_t count = columnarHeader(self)->columnCount, index = -1;
+  if (PyString_Check(which))
+  {
+    const char* name = PyString_AS_STRING(which);
+    for (Py_ssize_t i = 0; i < count && index == -1; i++)
+      if (strncmp(columnarColumns(self)[i].name, name, sizeof(ColumnarColumn().name)) == 0)
+        index = i;
+    if (index == -1)
+    {
+      PyErr_Format(PyExc_KeyError, "%s: No such column", name);
+      return NULL;
+    }
+  }
+  else
+  {
+    index = PyInt_AsSsize_t(which);
+    if (index == -1 && PyErr_Occurred())
+      return NULL;
+    if (index < 0 || index >= count)
+    {
+      PyErr_SetString(PyExc_IndexError, "ColumnarFile column out of range");
+      return NULL;
+    }
+  }
+
+  char* data = self->mMap + columnarHeader(self)->dataOffset + index * self->mRowCapacity * sizeof(double);
+  return (PyObject*)numericArrayView((PyObject*)self, 'd', sizeof(double), data, self->mRows);
+}
+
+static PyObject*
+columnarFileGetStatus(ColumnarFile* self, void* aClosure)
+{
+  switch (columnarHeader(self)->status)
+  {
+  case COLUMNAR_RUNNING:
+    return PyString_FromString("RUNNING");
+  case COLUMNAR_DONE:
+    return PyString_FromString("DONE");
+  default:
+    return PyString_FromString("FAILED");
+  }
+}
+
+static PyObject*
+columnarFileGetNames(ColumnarFile* self, void* aClosure)
+{
+  Py_ssize_t count = columnarHeader(self)->columnCount;
+  PyObject* lst = PyList_New(count);
+  if (lst == NULL)
+    return NULL;
+  for (Py_ssize_t i = 0; i < count; i++)
+  {
+    const char* name = columnarColumns(self)[i].name;
+    PyObject* item = PyString_FromStringAndSize(name, strnlen(name, sizeof(ColumnarColumn().name)));
+    if (item == NULL)
+    {
+      Py_DECREF(lst);
+      return NULL;
+    }
+    PyList_SET_ITEM(lst, i, item);
+  }
+  return lst;
+}
+
+static PyObject*
+columnarFileGetKinds(ColumnarFile* self, void* aClosure)
+{
+  Py_ssize_t count = columnarHeader(self)->columnCount;
+  PyObject* lst = PyList_New(count);
+  if (lst == NULL)
+    return NULL;
+  for (Py_ssize_t i = 0; i < count; i++)
+  {
+    uint32_t kind = columnarColumns(self)[i].kind;
+    if (kind > COLUMN_ALGEBRAIC)
+      kind = COLUMN_UNKNOWN;
+    PyObject* item = PyString_FromString(sColumnKindNames[kind]);
+    if (item == NULL)
+    {
+      Py_DECREF(lst);
+      return NULL;
+    }
+    PyList_SET_ITEM(lst, i, item);
+  }
+  return lst;
+}
+
+// The Enum objects made for one CGRS enum, indexed by value, so that each
+// enumerator is only ever converted once. Tables are shared by all type
+// objects with the same name, and are never freed.
+typedef std::vector<PyObject*> EnumTable;
+static std::unordered_map<std::string, EnumTable*> sEnumTables;
+// Tables by GenericType identity (only touched with the GIL held), bounded and
+// referenced like sTypeTags.
+static std::unordered_map<iface::CGRS::GenericType*, EnumTable*> sEnumTypeTables;
+static const size_t kMaxEnumTypeTables = 1024;
+// Larger indices than this are converted without being interned.
+static const int32_t kMaxInternedEnumIndex = 4096;
+
+static EnumTable*
+enumTableOf(iface::CGRS::GenericType* aType)
+{
+  std::unordered_map<iface::CGRS::GenericType*, EnumTable*>::iterator i = sEnumTypeTables.find(aType);
+  if (i != sEnumTypeTables.end())
+    return i->second;
+
+  if (sEnumTypeTables.size() >= kMaxEnumTypeTables)
+  {
+    for (i = sEnumTypeTables.begin(); i != sEnumTypeTables.end(); i++)
+      i->first->release_ref();
+    sEnumTypeTables.clear();
+  }
+
+  EnumTable*& table = sEnumTables[aType->asString()];
+  if (table == NULL)
+    table = new EnumTable();
+  aType->add_ref();
+  sEnumTypeTables[aType] = table;
+  return table;
+}
+
+static PyObject*
+genericValueToPythonEnum(iface::CGRS::GenericValue* aGenVal, iface::CGRS::GenericType* aType)
+{
+  DECLARE_QUERY_INTERFACE_OBJREF(ev, aGenVal, CGRS::EnumValue);
+  if (ev == NULL)
+    return NULL;
+
+  int32_t idx = ev->asLong();
+  EnumTable* table = NULL;
+  if (idx >= 0 && idx <= kMaxInternedEnumIndex)
+  {
+    table = enumTableOf(aType);
+    if (static_cast<size_t>(idx) < table->size() && (*table)[idx] != NULL)
+    {
+      Py_INCREF((*table)[idx]);
+      return (*table)[idx];
+    }
+  }
+
+  Enum *evo = sFreeEnums.alloc();
+  std::string s(ev->asString());
+  evo->asString = PyString_FromString(s.c_str());
+  evo->asInteger = idx;
+  evo->mInterned = table != NULL;
+  if (table != NULL)
+  {
+    if (static_cast<size_t>(idx) >= table->size())
+      table->resize(idx + 1, NULL);
+    (*table)[idx] = reinterpret_cast<PyObject*>(evo);
+    Py_INCREF(evo);
+  }
+  return reinterpret_cast<PyObject*>(evo);
+}
+
+static PyObject*
+genericValueToPythonObject(iface::CGRS::GenericValue* aGenVal)
+{
+  // Check it isn't a Python implemented object...
+  DECLARE_QUERY_INTERFACE_OBJREF(cov, aGenVal, CGRS::CallbackObjectValue);
+
+  if (cov != NULL)
+  {
+    PythonCallback* pycb = dynamic_cast<PythonCallback*>(static_cast<iface::CGRS::CallbackObjectValue*>(cov));
+
+    if (pycb == NULL)
+    {
+      // We could support this case by making a wrapper that uses invokeOnInterface
+      // to allow Python to call into a foreign callback, but it is an obscure corner
+      // case in terms of the current API implementation, so lets just do this.
+      PyErr_SetString(PyExc_ValueError, "Cannot convert a CGRS callback that didn't come from cgrspy to a Python object - this has not been implemented because we are not sure anyone would use it. File a tracker item against the CellML API at https://tracker.physiomeproject.org/ if you have a legitimate reason to want this.");
+      return NULL;
+    }
+
+    return pycb->getObject();
+  }
+
+  // Null objects come back from CGRS as void values.
+  DECLARE_QUERY_INTERFACE_OBJREF(obj, aGenVal, CGRS::ObjectValue);
+  if (obj == NULL)
+  {
+    Py_RETURN_NONE;
+  }
+  ObjRef<iface::XPCOM::IObject> v(obj->asObject());
+  if (v == NULL)
+  {
+    Py_RETURN_NONE;
+  }
+  return Object_new(v);
+}
+
+static PyObject*
+genericValueToPython(iface::CGRS::GenericValue* aGenVal)
+{
+  ObjRef<iface::CGRS::GenericType> gt(aGenVal->typeOfValue());
+  return genericValueToPython(aGenVal, gt, typeTagOf(gt));
+}
+
+// Converts a value already known to have type aType, whose tag is aTag.
+static PyObject*
+genericValueToPython(iface::CGRS::GenericValue* aGenVal, iface::CGRS::GenericType* aType,
+                     TypeTag aTag)
+{
+  if (sStatsEnabled)
+    sConversions[0][aTag]++;
+  switch (aTag)
+  {
+  case TYPE_VOID:
+    Py_RETURN_NONE;
+
+  case TYPE_BOOLEAN:
+    {
+      DECLARE_QUERY_INTERFACE_OBJREF(bv, aGenVal, CGRS::BooleanValue);
+      if (bv->asBoolean())
+      {
+        Py_RETURN_TRUE;
+      }
+      else
+      {
+        Py_RETURN_FALSE;
+      }
+    }
+
+  case TYPE_CHAR:
+    {
+      DECLARE_QUERY_INTERFACE_OBJREF(cv, aGenVal, CGRS::CharValue);
+      char v = cv->asChar();
+      return PyString_FromStringAndSize(&v, 1);
+    }
+
+  case TYPE_OCTET:
+    {
+      DECLARE_QUERY_INTERFACE_OBJREF(ov, aGenVal, CGRS::OctetValue);
+      return PyInt_FromLong(ov->asOctet());
+    }
+
+  case TYPE_SHORT:
+    {
+      DECLARE_QUERY_INTERFACE_OBJREF(sv, aGenVal, CGRS::ShortValue);
+      return PyInt_FromLong(sv->asShort());
+    }
+
+  case TYPE_LONG:
+    {
+      DECLARE_QUERY_INTERFACE_OBJREF(lv, aGenVal, CGRS::LongValue);
+      return PyInt_FromLong(lv->asLong());
+    }
+
+  case TYPE_LONG_LONG:
+    {
+      DECLARE_QUERY_INTERFACE_OBJREF(llv, aGenVal, CGRS::LongLongValue);
+      return PyLong_FromLongLong(llv->asLongLong());
+    }
+
+  case TYPE_USHORT:
+    {
+      DECLARE_QUERY_INTERFACE_OBJREF(usv, aGenVal, CGRS::UShortValue);
+      return PyInt_FromLong(usv->asUShort());
+    }
+
+  case TYPE_ULONG:
+    {
+      DECLARE_QUERY_INTERFACE_OBJREF(ulv, aGenVal, CGRS::ULongValue);
+      return PyLong_FromUnsignedLong(ulv->asULong());
+    }
+
+  case TYPE_ULONG_LONG:
+    {
+      DECLARE_QUERY_INTERFACE_OBJREF(ullv, aGenVal, CGRS::ULongLongValue);
+      return PyLong_FromUnsignedLongLong(ullv->asULongLong());
+    }
+
+  case TYPE_FLOAT:
+    {
+      DECLARE_QUERY_INTERFACE_OBJREF(fv, aGenVal, CGRS::FloatValue);
+      return PyFloat_FromDouble(fv->asFloat());
+    }
+
+  case TYPE_DOUBLE:
+    {
+      DECLARE_QUERY_INTERFACE_OBJREF(dv, aGenVal, CGRS::DoubleValue);
+      return PyFloat_FromDouble(dv->asDouble());
+    }
+
+  case TYPE_STRING:
+    {
+      DECLARE_QUERY_INTERFACE_OBJREF(sv, aGenVal, CGRS::StringValue);
+      return stringToPython(sv->asString());
+    }
+
+  case TYPE_WSTRING:
+    return genericValueToPythonW(aGenVal);
+
+  case TYPE_ENUM:
+    return genericValueToPythonEnum(aGenVal, aType);
+
+  case TYPE_SEQUENCE:
+    return genericValueToPythonSequence(aGenVal, aType);
+
+  case TYPE_OBJECT:
+  case TYPE_UNKNOWN:
+    return genericValueToPythonObject(aGenVal);
+  }
+
+  return NULL;
+}
+
+static iface::CGRS::GenericValue*
+pythonValueToGenericW(PyObject* aPyVal)
+{
+  // ASCII strs are widened directly.
+  if (PyString_Check(aPyVal))
+  {
+    const char* str = PyString_AS_STRING(aPyVal);
+    Py_ssize_t n = PyString_GET_SIZE(aPyVal), i = 0;
+    std::wstring s(n, L'\0');
+    while (i < n && static_cast<unsigned char>(str[i]) < 0x80)
+    {
+      s[i] = str[i];
+      i++;
+    }
+    if (i == n)
+      return sCGS->makeWString(s);
+  }
+
+  // Anything else is converted to unicode first (strs with the default
+  // encoding).
+  if (PyUnicode_Check(aPyVal))
+    Py_INCREF(aPyVal);
+  else
+    aPyVal = PyUnicode_FromObject(aPyVal);
+
+  if (aPyVal == NULL)
+    return NULL;
+
+  const Py_UNICODE* u = PyUnicode_AS_UNICODE(aPyVal);
+  Py_ssize_t n = PyUnicode_GET_SIZE(aPyVal);
+#if Py_UNICODE_SIZE == SIZEOF_WCHAR_T
+  std::wstring s(reinterpret_cast<const wchar_t*>(u), n);
+#else
+  // Join surrogate pairs from a UCS-2 Python into 32 bit characters.
+  std::wstring s;
+  s.reserve(n);
+  for (Py_ssize_t i = 0; i < n; i++)
+  {
+    uint32_t c = u[i];
+    if (c >= 0xD800 && c < 0xDC00 && i + 1 < n && u[i + 1] >= 0xDC00 && u[i + 1] < 0xE000)
+    {
+      c = 0x10000 + ((c - 0xD800) << 10) + (u[i + 1] - 0xDC00);
+      i++;
+    }
+    s += static_cast<wchar_t>(c);
+  }
+#endif
+  Py_DECREF(aPyVal);
+
+  return sCGS->makeWString(s);
+}
+
+static iface::CGRS::GenericValue*
+pythonValueToGenericSequence(PyObject* aPyVal, iface::CGRS::GenericType* aGenType)
+{
+  DECLARE_QUERY_INTERFACE_OBJREF(st, aGenType, CGRS::SequenceType);
+  Py_ssize_t l = PySequence_Length(aPyVal);
+  if (l == -1)
+    return NULL;
+
+  ObjRef<iface::CGRS::GenericType> innerType(st->innerType());
+  ObjRef<iface::CGRS::SequenceValue> sv(sCGS->makeSequence(innerType));
+  for (Py_ssize_t i = 0; i < l; i++)
+  {
+    PyObject* pyItem = PySequence_GetItem(aPyVal, i);
+    ObjRef<iface::CGRS::GenericValue> gitem = pythonToGenericValue(pyItem, innerType);
+    Py_DECREF(pyItem);
+    if (gitem == NULL)
+      return NULL;
+
+    sv->appendValue(gitem);
+  }
+
+  sv->add_ref();
+  return sv;
+}
+
+static iface::CGRS::GenericValue*
+pythonValueToGenericEnum(PyObject* aObj, iface::CGRS::GenericType* aType)
+{
+  DECLARE_QUERY_INTERFACE_OBJREF(et, aType, CGRS::EnumType);
+  PyObject* iv = PyObject_GetAttrString(aObj, "asInteger");
+  if (iv != NULL)
+  {
+    PyErr_Clear();
+    long idx = PyInt_AsLong(iv);
+    Py_DECREF(iv);
+    if (!PyErr_Occurred())
+      return sCGS->makeEnumFromIndex(et, idx);
+  }
+  PyErr_Clear();
+
+  iv = PyObject_GetAttrString(aObj, "asString");
+  if (!iv)
+    return NULL;
+  char* str = PyString_AsString(iv);
+  iface::CGRS::GenericValue* gv = NULL;
+  if (str != NULL)
+    gv = sCGS->makeEnumFromString(et, str);
+  Py_DECREF(iv);
+  return gv;
+}
+
+static already_AddRefd<iface::CGRS::GenericValue>
+pythonToGenericValue(PyObject* aObj, iface::CGRS::GenericType* aType)
+{
+  return pythonToGenericValue(aObj, aType, typeTagOf(aType));
+}
+
+// Converts to aType, whose tag is already known to be aTag.
+static already_AddRefd<iface::CGRS::GenericValue>
+pythonToGenericValue(PyObject* aObj, iface::CGRS::GenericType* aType, TypeTag aTag)
+{
+  if (sStatsEnabled)
+    sConversions[1][aTag]++;
+  switch (aTag)
+  {
+  case TYPE_OBJECT:
+    // See if aObj is a wrapped native object...
+    if (PyObject_TypeCheck(aObj, &ObjectType))
+    {
+      iface::CGRS::ObjectValue* ov = objectValue(reinterpret_cast<Object*>(aObj), sCGS);
+      ov->add_ref();
+      return static_cast<iface::CGRS::GenericValue*>(ov);
+    }
+
+    // ... or a native observer.
+    if (PyObject_TypeCheck(aObj, &RecorderType) || PyObject_TypeCheck(aObj, &ColumnarSinkType))
+    {
+      NativeObserver* no = reinterpret_cast<Observer*>(aObj)->mObserver;
+      no->add_ref();
+      return static_cast<iface::CGRS::GenericValue*>(no);
+    }
+
+    // aObj is a Python object - wrap it in a callback.
+    return new PythonCallback(aObj);
+
+  case TYPE_ENUM:
+    return pythonValueToGenericEnum(aObj, aType);
+
+  case TYPE_VOID:
+    return sCGS->makeVoid();
+
+  case TYPE_BOOLEAN:
+    return sCGS->makeBoolean(!!(PyInt_AsLong(aObj)));
+
+  case TYPE_CHAR:
+    {
+      char * v = PyString_AsString(aObj);
+      if (v == NULL)
+        return NULL;
+      return sCGS->makeChar(v[0]);
+    }
+
+  case TYPE_OCTET:
+    return sCGS->makeOctet(static_cast<uint8_t>(PyInt_AsLong(aObj)));
+
+  case TYPE_SHORT:
+    return sCGS->makeShort(static_cast<int16_t>(PyInt_AsLong(aObj)));
+
+  case TYPE_LONG:
+    return sCGS->makeLong(static_cast<int32_t>(PyInt_AsLong(aObj)));
+
+  case TYPE_LONG_LONG:
+    return sCGS->makeLongLong(PyLong_AsLongLong(aObj));
+
+  case TYPE_USHORT:
+    return sCGS->makeUShort(static_cast<uint16_t>(PyInt_AsLong(aObj)));
+
+  case TYPE_ULONG:
+    return sCGS->makeULong(static_cast<uint32_t>(PyLong_AsLongLong(aObj)));
+
+  case TYPE_ULONG_LONG:
+    return sCGS->makeULongLong(static_cast<uint64_t>(PyLong_AsLongLong(aObj)));
+
+  case TYPE_FLOAT:
+    return sCGS->makeFloat(static_cast<float>(PyFloat_AsDouble(aObj)));
+
+  case TYPE_DOUBLE:
+    return sCGS->makeDouble(PyFloat_AsDouble(aObj));
+
+  case TYPE_STRING:
+    {
+      char* sb = PyString_AsString(aObj);
+      if (sb == NULL)
+        return NULL;
+      std::string s(sb, PyString_Size(aObj));
+      return sCGS->makeString(s);
+    }
+
+  case TYPE_WSTRING:
+    return pythonValueToGenericW(aObj);
+
+  case TYPE_SEQUENCE:
+    return pythonValueToGenericSequence(aObj, aType);
+
+  case TYPE_UNKNOWN:
+    break;
+  }
+
+  // Shouldn't happen.
+  PyErr_SetString(PyExc_TypeError, "Cannot convert to an unrecognised CGRS type");
+  return NULL;
+}
+
+// The parameter and return types of an operation, captured when it is
+// resolved so that calling it needs no reflection.
+struct MethodDescriptor
+{
+  MethodDescriptor()
+    : inCount(0), outCount(0), returnTag(TYPE_UNKNOWN)
+  {
+  }
+
+  void describe(iface::CGRS::GenericMethod* aMethod)
+  {
+    std::vector<iface::CGRS::GenericParameter*> params(aMethod->parameters());
+    for (std::vector<iface::CGRS::GenericParameter*>::iterator i = params.begin();
+         i != params.end(); i++)
+    {
+      if ((*i)->isIn())
+      {
+        ObjRef<iface::CGRS::GenericType> t((*i)->type());
+        inTypes.push_back(t);
+        inTags.push_back(typeTagOf(t));
+      }
+      if ((*i)->isOut())
+      {
+        ObjRef<iface::CGRS::GenericType> t((*i)->type());
+        outTypes.push_back(t);
+        outTags.push_back(typeTagOf(t));
+      }
+      (*i)->release_ref();
+    }
+    inCount = inTypes.size();
+    outCount = outTypes.size();
+    returnType = aMethod->returnType();
+    returnTag = typeTagOf(returnType);
+  }
+
+  size_t inCount, outCount;
+  std::vector<ObjRef<iface::CGRS::GenericType> > inTypes;
+  std::vector<TypeTag> inTags;
+  std::vector<ObjRef<iface::CGRS::GenericType> > outTypes;
+  std::vector<TypeTag> outTags;
+  ObjRef<iface::CGRS::GenericType> returnType;
+  TypeTag returnTag;
+};
+
+// Descriptors shared by every InterfaceSet and callback member that resolves
+// the same member of the same interface, so that each is described once. They
+// are keyed by interface and member name, and by aKind: 'g' for a getter, 's'
+// for a setter and 'o' for an operation. Descriptors from before a generic
+// module was loaded are still used by Method objects, so they are never freed.
+// Only used with the GIL held.
+struct SharedDescriptor
+{
+  SharedDescriptor()
+    : generation(0), descriptor(NULL)
+  {
+  }
+
+  unsigned long generation;
+  MethodDescriptor* descriptor;
+};
+static std::unordered_map<std::string, SharedDescriptor> sMethodDescriptors;
+static const MethodDescriptor sNoDescriptor;
+
+static const MethodDescriptor*
+describeMethod(const std::string& aInterfaceName, const std::string& aMemberName, char aKind,
+               iface::CGRS::GenericMethod* aMethod, unsigned long aGeneration)
+{
+  std::string key(aInterfaceName);
+  key += '\n';
+  key += aMemberName;
+  key += '\n';
+  key += aKind;
+  SharedDescriptor& sd = sMethodDescriptors[key];
+  if (sd.descriptor == NULL || sd.generation != aGeneration)
+  {
+    sd.generation = aGeneration;
+    sd.descriptor = new MethodDescriptor();
+    sd.descriptor->describe(aMethod);
+  }
+  return sd.descriptor;
+}
+
+// A native member resolved by name against a list of supported interfaces.
+struct ResolvedMember
+{
+  ResolvedMember(const char* aName)
+    : name(aName), found(false), isAttribute(false), typeTag(TYPE_UNKNOWN),
+      descriptor(&sNoDescriptor), policyGeneration(0), releaseGIL(false), stats(NULL),
+      traceName(NULL)
+  {
+  }
+
+  std::string name;
+  bool found;
+  bool isAttribute;
+  std::string interfaceName;
+  // The attribute getter or setter, or the operation.
+  ObjRef<iface::CGRS::GenericMethod> method;
+  // The attribute type and its tag (only used for setters).
+  ObjRef<iface::CGRS::GenericType> type;
+  TypeTag typeTag;
+  // Only used for operations; see describeMethod.
+  const MethodDescriptor* descriptor;
+  // Cached result of the GIL policy lookup; see releasesGIL.
+  mutable unsigned long policyGeneration;
+  mutable bool releaseGIL;
+  // Found on first use; see memberStatsOf and memberTraceName.
+  mutable MemberStats* stats;
+  mutable const char* traceName;
+};
+
+static MemberStats*
+memberStatsOf(const ResolvedMember& aMember)
+{
+  if (aMember.stats == NULL)
+    aMember.stats = memberStats(aMember.interfaceName, aMember.name);
+  return aMember.stats;
+}
+
+static const char*
+memberTraceName(const ResolvedMember& aMember)
+{
+  return traceName(aMember.traceName, aMember.interfaceName, aMember.name);
+}
+
+// The interfaces supported by a class of native objects, together with a cache
+// of the members looked up on them by name. Resolving a name through CGRS
+// reflection costs a getInterfaceByName call per interface and an exception
+// for every interface that lacks the member, so both hits and misses are
+// cached here.
+class InterfaceSet
+{
+public:
+  InterfaceSet(const std::vector<std::string>& aNames)
+    : mSupportedNames(aNames), mGeneration(0)
+  {
+  }
+
+  const ResolvedMember& findGettable(iface::CGRS::GenericsService* aCGS, const char* aName)
+  {
+    refresh(aCGS);
+
+    MemberMap::iterator it = mGettable.find(aName);
+    if (it != mGettable.end())
+      return *it->second;
+
+    ResolvedMember& rm = insertMember(mGettable, aName);
+    const std::string& name = rm.name;
+    for (size_t i = 0; i < mInterfaces.size(); i++)
+    {
+      ObjRef<iface::CGRS::GenericAttribute> at;
+      try { at = mInterfaces[i]->getAttributeByName(name); }
+      catch (...) { noteSwallowed(mNames[i], name); }
+      if (at != NULL)
+      {
+        rm.found = true;
+        rm.isAttribute = true;
+        rm.interfaceName = mNames[i];
+        rm.method = at->getter();
+        return rm;
+      }
+
+      ObjRef<iface::CGRS::GenericMethod> meth;
+      try { meth = mInterfaces[i]->getOperationByName(name); }
+      catch (...) { noteSwallowed(mNames[i], name); }
+      if (meth != NULL)
+      {
+        rm.found = true;
+        rm.interfaceName = mNames[i];
+        rm.method = meth;
+        rm.descriptor = describeMethod(mNames[i], name, 'o', meth, sGeneration);
+        return rm;
+      }
+    }
+
+    return rm;
+  }
+
+  const ResolvedMember& findSettable(iface::CGRS::GenericsService* aCGS, const char* aName)
+  {
+    refresh(aCGS);
+
+    MemberMap::iterator it = mSettable.find(aName);
+    if (it != mSettable.end())
+      return *it->second;
+
+    ResolvedMember& rm = insertMember(mSettable, aName);
+    const std::string& name = rm.name;
+    for (size_t i = 0; i < mInterfaces.size(); i++)
+    {
+      ObjRef<iface::CGRS::GenericAttribute> at;
+      try { at = mInterfaces[i]->getAttributeByName(name); }
+      catch (...) { noteSwallowed(mNames[i], name); }
+      if (at == NULL || at->isReadonly())
+        continue;
+
+      rm.found = true;
+      rm.isAttribute = true;
+      rm.interfaceName = mNames[i];
+      rm.method = at->setter();
+      rm.type = at->type();
+      rm.typeTag = typeTagOf(rm.type);
+      return rm;
+    }
+
+    return rm;
+  }
+
+  // Bumped whenever a generic module is loaded, since that can make more
+  // interfaces (and so more members) known to CGRS.
+  static unsigned long sGeneration;
+
+private:
+  // Members are keyed by C string so that lookups from tp_getattr do not need
+  // to build a std::string; the keys point into the ResolvedMember itself.
+  struct NameHash
+  {
+    size_t operator()(const char* aName) const
+    {
+      size_t h = 2166136261u;
+      for (; *aName; aName++)
+        h = (h ^ static_cast<unsigned char>(*aName)) * 16777619u;
+      return h;
+    }
+  };
+
+  struct NameEqual
+  {
+    bool operator()(const char* aA, const char* aB) const
+    {
+      return strcmp(aA, aB) == 0;
+    }
+  };
+
+  typedef std::unordered_map<const char*, ResolvedMember*, NameHash, NameEqual> MemberMap;
+
+  static ResolvedMember& insertMember(MemberMap& aMap, const char* aName)
+  {
+    ResolvedMember* rm = new ResolvedMember(aName);
+    aMap[rm->name.c_str()] = rm;
+    return *rm;
+  }
+
+  // Resolved members can still be in use by Method objects, or by calls that
+  // have released the GIL, so they are retired rather than deleted.
+  void retireMembers(MemberMap& aMap)
+  {
+    for (MemberMap::iterator i = aMap.begin(); i != aMap.end(); i++)
+      mRetired.push_back(i->second);
+    aMap.clear();
+  }
+
+  void refresh(iface::CGRS::GenericsService* aCGS)
+  {
+    if (mGeneration == sGeneration)
+      return;
+
+    mGeneration = sGeneration;
+    retireMembers(mGettable);
+    retireMembers(mSettable);
+    mInterfaces.clear();
+    mNames.clear();
+    for (std::vector<std::string>::iterator i = mSupportedNames.begin();
+         i != mSupportedNames.end(); i++)
+    {
+      ObjRef<iface::CGRS::GenericInterface> gi;
+      try { gi = aCGS->getInterfaceByName(*i); }
+      catch (...) { noteSwallowed(*i, ""); }
+      if (gi == NULL)
+        continue;
+      mInterfaces.push_back(gi);
+      mNames.push_back(*i);
+    }
+  }
+
+  std::vector<std::string> mSupportedNames;
+  unsigned long mGeneration;
+  // The subset of mSupportedNames known to CGRS, and their reflection objects.
+  std::vector<std::string> mNames;
+  std::vector<ObjRef<iface::CGRS::GenericInterface> > mInterfaces;
+  MemberMap mGettable, mSettable;
+  std::vector<ResolvedMember*> mRetired;
+};
+
+unsigned long InterfaceSet::sGeneration = 1;
+
+// What a Python implementation of one native member is called with: the
+// member's parameter and return types. Shared by all callbacks, and refreshed
+// when a generic module is loaded.
+struct CallbackMember
+{
+  CallbackMember()
+    : generation(0), found(false), descriptor(&sNoDescriptor), stats(NULL), traceName(NULL),
+      attributeName(NULL), explicitAttributeName(NULL)
+  {
+  }
+
+  unsigned long generation;
+  bool found;
+  // See describeMethod.
+  const MethodDescriptor* descriptor;
+  MemberStats* stats;
+  mutable const char* traceName;
+  // The names a Python implementation may use for the member: the member
+  // name, and Interface_member (with '_' for each '::'). Made on first use.
+  mutable PyObject* attributeName;
+  mutable PyObject* explicitAttributeName;
+};
+
+// Callback members by interface name and then member name; the first of each
+// pair is for calls with no arguments (getters and most operations), the
+// second for calls with arguments (setters and other operations). Only used
+// with the GIL held, and never freed, so pointers into it remain valid.
+typedef std::unordered_map<std::string, std::pair<CallbackMember, CallbackMember> > CallbackMemberMap;
+static std::unordered_map<std::string, CallbackMemberMap> sCallbackMembers;
+
+static const CallbackMember*
+findCallbackMember(const std::string& aInterfaceName, const std::string& aMethodName,
+                   bool aHasArguments)
+{
+  std::pair<CallbackMember, CallbackMember>& members = sCallbackMembers[aInterfaceName][aMethodName];
+  CallbackMember& cm = aHasArguments ? members.second : members.first;
+  if (cm.generation == InterfaceSet::sGeneration)
+    return &cm;
+
+  cm.generation = InterfaceSet::sGeneration;
+  cm.found = false;
+  cm.descriptor = &sNoDescriptor;
+  if (cm.stats == NULL)
+    cm.stats = memberStats(aInterfaceName, aMethodName);
+
+  ObjRef<iface::CGRS::GenericInterface> gi;
+  try { gi = sCGS->getInterfaceByName(aInterfaceName); }
+  catch (...) { noteSwallowed(aInterfaceName, ""); }
+  if (gi == NULL)
+    return &cm;
+
+  ObjRef<iface::CGRS::GenericMethod> gm;
+  ObjRef<iface::CGRS::GenericAttribute> ga;
+  char kind = 'o';
+  try { ga = gi->getAttributeByName(aMethodName.c_str()); }
+  catch (...) { noteSwallowed(aInterfaceName, aMethodName); }
+  if (ga != NULL)
+  {
+    kind = aHasArguments ? 's' : 'g';
+    if (!aHasArguments)
+      gm = ga->getter();
+    else
+      gm = ga->setter();
+  }
+  else
+  {
+    try { gm = gi->getOperationByName(aMethodName); }
+    catch (...) { noteSwallowed(aInterfaceName, aMethodName); }
+  }
+
+  if (gm != NULL)
+  {
+    cm.found = true;
+    cm.descriptor = describeMethod(aInterfaceName, aMethodName, kind, gm, cm.generation);
+  }
+  return &cm;
+}
+
+PyObject*
+PythonCallback::findCallable(const CallbackMember* aMember, const std::string& aInterfaceName,
+                             const std::string& aMethodName)
+{
+  if (aMember->attributeName == NULL)
+  {
+    aMember->attributeName = PyString_InternFromString(aMethodName.c_str());
+    if (aMember->attributeName == NULL)
+    {
+      PyErr_Clear();
+      return NULL;
+    }
+  }
+
+  PyObject* meth = PyObject_GetAttr(mPyObject, aMember->attributeName);
+  if (meth != NULL)
+    return meth;
+  PyErr_Clear();
+
+  // Check for the explicitly named version...
+  if (aMember->explicitAttributeName == NULL)
+  {
+    std::string ename;
+    bool skipnext = false;
+    for (std::string::const_iterator i = aInterfaceName.begin(); i != aInterfaceName.end(); i++)
+    {
+      if (skipnext)
+      {
+        skipnext = false;
+        continue;
+      }
+      if (*i == ':')
+      {
+        ename += '_';
+        skipnext = true;
+      }
+      else
+        ename += *i;
+    }
+    ename += '_';
+    ename += aMethodName;
+    aMember->explicitAttributeName = PyString_InternFromString(ename.c_str());
+    if (aMember->explicitAttributeName == NULL)
+    {
+      PyErr_Clear();
+      return NULL;
+    }
+  }
+
+  meth = PyObject_GetAttr(mPyObject, aMember->explicitAttributeName);
+  if (meth == NULL)
+    PyErr_Clear();
+  return meth;
+}
+
+static PyObject*
+callbackArguments(const CallbackMember* aMember, const std::vector<iface::CGRS::GenericValue*>& aValues)
+{
+  const MethodDescriptor& desc = *aMember->descriptor;
+  PyObject* args = PyTuple_New(aValues.size());
+  for (size_t i = 0; i < aValues.size(); i++)
+  {
+    if (i < desc.inCount)
+      PyTuple_SET_ITEM(args, i, genericValueToPython(aValues[i], desc.inTypes[i], desc.inTags[i]));
+    else
+      PyTuple_SET_ITEM(args, i, genericValueToPython(aValues[i]));
+  }
+  return args;
+}
+
+// The void callback members that are delivered asynchronously, by interface
+// name and then member name. Native threads read this without the GIL, so it
+// is replaced rather than changed, and old versions are never freed.
+typedef std::unordered_map<std::string, std::unordered_set<std::string> > AsyncMemberMap;
+static std::atomic<const AsyncMemberMap*> sAsyncMembers(NULL);
+
+static bool
+isAsyncMember(const std::string& aInterfaceName, const std::string& aMethodName)
+{
+  const AsyncMemberMap* members = sAsyncMembers.load(std::memory_order_acquire);
+  if (members == NULL)
+    return false;
+  AsyncMemberMap::const_iterator i = members->find(aInterfaceName);
+  return i != members->end() && i->second.count(aMethodName) != 0;
+}
+
+// A call to an asynchronous member, queued by the native thread that made it.
+struct QueuedCallback
+{
+  PythonCallback* callback;
+  std::string interfaceName, methodName;
+  std::vector<iface::CGRS::GenericValue*> arguments;
+  QueuedCallback* next;
+};
+
+// Pushed without locking, newest first.
+static std::atomic<QueuedCallback*> sQueuedCallbacks(NULL);
+// Whether a pending call to deliver them has been scheduled and not yet run.
+static std::atomic<bool> sDeliveryScheduled(false);
+// The thread delivering queued callbacks, if any. Only set with the GIL held,
+// and cleared under sDeliveryLock, signalling sDeliveryDone, so that threads
+// can wait for a delivery to finish without the GIL.
+static std::atomic<long> sDeliveringThread(0);
+static std::mutex sDeliveryLock;
+static std::condition_variable sDeliveryDone;
+
+static void
+queueCallback(PythonCallback* aCallback, const std::string& aInterfaceName,
+              const std::string& aMethodName, const std::vector<iface::CGRS::GenericValue*>& aArguments);
+static int deliverQueuedCallbacks(void*);
+
+// Whether two queued calls are to the same member of the same object with a
+// single argument each, so that they can be delivered as one call with the
+// arguments concatenated.
+static bool
+canCoalesce(QueuedCallback* aA, QueuedCallback* aB)
+{
+  return aA->callback == aB->callback && aA->arguments.size() == 1 &&
+    aB->arguments.size() == 1 && aA->methodName == aB->methodName &&
+    aA->interfaceName == aB->interfaceName;
+}
+
+// Joins lists, or NumericArrays of one type, into a single new one. Returns
+// NULL without an exception set if aParts are not all alike.
+static PyObject*
+joinSequences(const std::vector<PyObject*>& aParts)
+{
+  bool lists = PyList_CheckExact(aParts[0]);
+  NumericArray* arr0 = reinterpret_cast<NumericArray*>(aParts[0]);
+  Py_ssize_t length = 0;
+  for (size_t i = 0; i < aParts.size(); i++)
+  {
+    if (lists ? !PyList_CheckExact(aParts[i]) :
+        (Py_TYPE(aParts[i]) != &NumericArrayType ||
+         reinterpret_cast<NumericArray*>(aParts[i])->mFormat[0] != arr0->mFormat[0]))
+      return NULL;
+    length += lists ? PyList_GET_SIZE(aParts[i]) : reinterpret_cast<NumericArray*>(aParts[i])->mLength;
+  }
+
+  if (lists)
+  {
+    PyObject* joined = PyList_New(length);
+    Py_ssize_t pos = 0;
+    for (size_t i = 0; i < aParts.size(); i++)
+      for (Py_ssize_t j = 0; j < PyList_GET_SIZE(aParts[i]); j++)
+      {
+        PyObject* item = PyList_GET_ITEM(aParts[i], j);
+        Py_INCREF(item);
+        PyList_SET_ITEM(joined, pos++, item);
+      }
+    return joined;
+  }
+
+  NumericArray* joined = numericArrayNew(arr0->mFormat[0], arr0->mItemSize, length);
+  if (joined == NULL)
+  {
+    PyErr_Clear();
+    return NULL;
+  }
+  char* p = joined->mData;
+  for (size_t i = 0; i < aParts.size(); i++)
+  {
+    NumericArray* arr = reinterpret_cast<NumericArray*>(aParts[i]);
+    memcpy(p, arr->mData, arr->mLength * arr->mItemSize);
+    p += arr->mLength * arr->mItemSize;
+  }
+  return reinterpret_cast<PyObject*>(joined);
+}
+
+void
+PythonCallback::deliver(const std::string& aInterfaceName, const std::string& aMethodName,
+                        PyObject* aArgs)
+{
+  const CallbackMember* cm = findCallbackMember(aInterfaceName, aMethodName, PyTuple_GET_SIZE(aArgs) != 0);
+  PyObject* meth = cm->found ? findCallable(cm, aInterfaceName, aMethodName) : NULL;
+  if (meth == NULL)
+    return;
+
+  sPythonCalls++;
+  uint64_t start = sStatsEnabled ? nowNs() : 0;
+  PyObject* ret;
+  {
+    ScopedTrace trace(tracing() ? traceName(cm->traceName, aInterfaceName, aMethodName) : NULL,
+                      "callback");
+    ret = PyObject_Call(meth, aArgs, NULL);
+  }
+  if (start != 0)
+    cm->stats->callback.record(start, ret == NULL);
+  if (ret == NULL)
+    PyErr_WriteUnraisable(meth);
+  else
+    Py_DECREF(ret);
+  Py_DECREF(meth);
+}
+
+// Delivers the queued calls, oldest first, and returns how many there were.
+// Called with the GIL held; exceptions raised by the callbacks are reported
+// with PyErr_WriteUnraisable, since the native caller has moved on.
+static long
+deliverAllQueuedCallbacks()
+{
+  if (sDeliveringThread != 0 || sQueuedCallbacks.load(std::memory_order_relaxed) == NULL)
+    return 0;
+
+  sDeliveringThread = PyThread_get_thread_ident();
+  long delivered = 0;
+  QueuedCallback* q;
+  while ((q = sQueuedCallbacks.exchange(NULL, std::memory_order_acquire)) != NULL)
+  {
+    QueuedCallback* first = NULL;
+    while (q != NULL)
+    {
+      QueuedCallback* next = q->next;
+      q->next = first;
+      first = q;
+      q = next;
+    }
+
+    while (first != NULL)
+    {
+      const CallbackMember* cm = findCallbackMember(first->interfaceName, first->methodName,
+                                                    !first->arguments.empty());
+      PyObject* args = callbackArguments(cm, first->arguments);
+
+      // Merge the arguments of following calls to the same member where we can.
+      QueuedCallback* last = first;
+      if (last->next != NULL && canCoalesce(first, last->next))
+      {
+        std::vector<PyObject*> parts;
+        parts.push_back(PyTuple_GET_ITEM(args, 0));
+        Py_INCREF(parts[0]);
+        QueuedCallback* q = first->next;
+        for (; q != NULL && canCoalesce(first, q); q = q->next)
+        {
+          PyObject* moreArgs = callbackArguments(cm, q->arguments);
+          parts.push_back(PyTuple_GET_ITEM(moreArgs, 0));
+          Py_INCREF(parts.back());
+          Py_DECREF(moreArgs);
+        }
+
+        PyObject* joined = joinSequences(parts);
+        if (joined != NULL)
+        {
+          PyTuple_SetItem(args, 0, joined);
+          while (last->next != q)
+            last = last->next;
+        }
+        for (size_t i = 0; i < parts.size(); i++)
+          Py_DECREF(parts[i]);
+      }
+
+      first->callback->deliver(first->interfaceName, first->methodName, args);
+      Py_DECREF(args);
+
+      QueuedCallback* end = last->next;
+      while (first != end)
+      {
+        QueuedCallback* next = first->next;
+        for (std::vector<iface::CGRS::GenericValue*>::iterator i = first->arguments.begin();
+             i != first->arguments.end(); i++)
+          (*i)->release_ref();
+        first->callback->release_ref();
+        delete first;
+        delivered++;
+        first = next;
+      }
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(sDeliveryLock);
+    sDeliveringThread = 0;
+  }
+  sDeliveryDone.notify_all();
+  return delivered;
+}
+
+static int
+deliverQueuedCallbacks(void*)
+{
+  sDeliveryScheduled.store(false, std::memory_order_release);
+  deliverAllQueuedCallbacks();
+  return 0;
+}
+
+static void
+queueCallback(PythonCallback* aCallback, const std::string& aInterfaceName,
+              const std::string& aMethodName, const std::vector<iface::CGRS::GenericValue*>& aArguments)
+{
+  QueuedCallback* q = new QueuedCallback;
+  q->callback = aCallback;
+  aCallback->add_ref();
+  q->interfaceName = aInterfaceName;
+  q->methodName = aMethodName;
+  q->arguments = aArguments;
+  for (std::vector<iface::CGRS::GenericValue*>::iterator i = q->arguments.begin();
+       i != q->arguments.end(); i++)
+    (*i)->add_ref();
+
+  q->next = sQueuedCallbacks.load(std::memory_order_relaxed);
+  while (!sQueuedCallbacks.compare_exchange_weak(q->next, q, std::memory_order_release,
+                                                 std::memory_order_relaxed))
+    ;
+  // If the pending call cannot be added, the next queued call tries again.
+  if (!sDeliveryScheduled.exchange(true, std::memory_order_acq_rel) &&
+      Py_AddPendingCall(deliverQueuedCallbacks, NULL) != 0)
+    sDeliveryScheduled.store(false, std::memory_order_release);
+}
+
+already_AddRefd<iface::CGRS::GenericValue>
+PythonCallback::invokeOnInterface(const std::string& aInterfaceName, const std::string& aMethodName,
+                                  const std::vector<iface::CGRS::GenericValue*>& aInValues,
+                                  std::vector<iface::CGRS::GenericValue*>& aOutValues,
+                                  bool* aWasException
+                                  ) throw()
+{
+  if (isAsyncMember(aInterfaceName, aMethodName))
   {
-    DECLARE_QUERY_INTERFACE_OBJREF(ov, aGenVal, CGRS::OctetValue);
-    return PyInt_FromLong(ov->asOctet());
+    queueCallback(this, aInterfaceName, aMethodName, aInValues);
+    *aWasException = false;
+    return sCGS->makeVoid();
+  }
+
+  ScopedGIL gil;
+  releasePendingDecrefs(NULL);
+  // Anything queued earlier must reach Python before this call does, even if
+  // another thread is part way through delivering it.
+  while (sDeliveringThread != 0 && sDeliveringThread != PyThread_get_thread_ident())
+  {
+    ScopedGILRelease nogil(true);
+    std::unique_lock<std::mutex> lock(sDeliveryLock);
+    sDeliveryDone.wait(lock, []() { return sDeliveringThread == 0; });
+  }
+  deliverAllQueuedCallbacks();
+
+  // One Python type can map to multiple GenericValue types, and so we have to
+  // look up the type to produce the correct output...
+  const CallbackMember* cm = findCallbackMember(aInterfaceName, aMethodName, !aInValues.empty());
+  if (!cm->found)
+    return sCGS->makeVoid();
+
+  PyObject* meth = findCallable(cm, aInterfaceName, aMethodName);
+  if (meth == NULL)
+    return sCGS->makeVoid();
+
+  const MethodDescriptor& desc = *cm->descriptor;
+  PyObject* ptin = callbackArguments(cm, aInValues);
+
+  sPythonCalls++;
+  uint64_t start = sStatsEnabled ? nowNs() : 0;
+  PyObject* ret;
+  {
+    ScopedTrace trace(tracing() ? traceName(cm->traceName, aInterfaceName, aMethodName) : NULL,
+                      "callback");
+    ret = PyObject_Call(meth, ptin, NULL);
+  }
+  Py_DECREF(ptin);
+  Py_DECREF(meth);
+  if (start != 0)
+    cm->stats->callback.record(start, ret == NULL);
+
+  if (PyErr_Occurred())
+  {
+    if (ret != NULL)
+      Py_DECREF(ret);
+    *aWasException = true;
+    return sCGS->makeVoid();
+  }
+  *aWasException = false;
+
+  // Values that cannot be converted are left out (as is anything missing
+  // from a short tuple), rather than leaving an exception pending when the
+  // GIL is released.
+  if (!PyTuple_Check(ret))
+  {
+    iface::CGRS::GenericValue* gv = pythonToGenericValue(ret, desc.returnType, desc.returnTag);
+    Py_DECREF(ret);
+    if (gv == NULL)
+    {
+      PyErr_Clear();
+      return sCGS->makeVoid();
+    }
+    return gv;
+  }
+
+  // Note: PyTuple_GET_ITEM returns borrowed references.
+  Py_ssize_t size = PyTuple_GET_SIZE(ret);
+  iface::CGRS::GenericValue* gvret = NULL;
+  if (size > 0)
+    gvret = pythonToGenericValue(PyTuple_GET_ITEM(ret, 0), desc.returnType, desc.returnTag);
+  for (size_t i = 0; i < desc.outTypes.size() && static_cast<Py_ssize_t>(i + 1) < size; i++)
+  {
+    iface::CGRS::GenericValue* out =
+      pythonToGenericValue(PyTuple_GET_ITEM(ret, i + 1), desc.outTypes[i], desc.outTags[i]);
+    if (out == NULL)
+      break;
+    aOutValues.push_back(out);
+  }
+  Py_DECREF(ret);
+  PyErr_Clear();
+
+  if (gvret == NULL)
+    return sCGS->makeVoid();
+  return gvret;
+}
+
+// Process-wide table of InterfaceSets, keyed by the newline-joined interface
+// list. Entries are never freed, so pointers into it remain valid.
+static std::unordered_map<std::string, InterfaceSet*> sInterfaceSets;
+
+static InterfaceSet*
+findInterfaceSet(iface::XPCOM::IObject* aObject)
+{
+  std::vector<std::string> v(aObject->supported_interfaces());
+  std::string key;
+  for (std::vector<std::string>::iterator i = v.begin(); i != v.end(); i++)
+  {
+    key += *i;
+    key += '\n';
+  }
+
+  InterfaceSet*& is = sInterfaceSets[key];
+  if (is == NULL)
+    is = new InterfaceSet(v);
+  return is;
+}
+
+// Whether the GIL is released while native members run. Policies can be set
+// per member ("Interface\nmember"), per interface, or as a default; see
+// bootstrap_setGILPolicy.
+static std::unordered_map<std::string, bool> sGILPolicies;
+static bool sDefaultReleaseGIL = true;
+static unsigned long sGILPolicyGeneration = 1;
+
+static bool
+releasesGIL(const ResolvedMember& aMember)
+{
+  if (aMember.policyGeneration != sGILPolicyGeneration)
+  {
+    aMember.policyGeneration = sGILPolicyGeneration;
+    aMember.releaseGIL = sDefaultReleaseGIL;
+    std::unordered_map<std::string, bool>::iterator i =
+      sGILPolicies.find(aMember.interfaceName + '\n' + aMember.name);
+    if (i == sGILPolicies.end())
+      i = sGILPolicies.find(aMember.interfaceName);
+    if (i != sGILPolicies.end())
+      aMember.releaseGIL = i->second;
+  }
+  return aMember.releaseGIL;
+}
+
+static InterfaceSet*
+objectInterfaceSet(Object* aObj)
+{
+  if (aObj->mInterfaceSet == NULL)
+    aObj->mInterfaceSet = findInterfaceSet(aObj->mObject);
+  return aObj->mInterfaceSet;
+}
+
+static iface::CGRS::ObjectValue*
+objectValue(Object* aObj, iface::CGRS::GenericsService* aCGS)
+{
+  if (aObj->mObjectValue == NULL)
+  {
+    ObjRef<iface::CGRS::GenericValue> gobject(aCGS->makeObject(aObj->mObject));
+    DECLARE_QUERY_INTERFACE_OBJREF(oobject, gobject, CGRS::ObjectValue);
+    aObj->mObjectValue = oobject;
+    aObj->mObjectValue->add_ref();
+  }
+  return aObj->mObjectValue;
+}
+
+// Whether aMember is the next() operation of an iterator, which
+// objectIterNext calls directly (and may prefetch results from).
+static bool
+isIteratorNext(const ResolvedMember& aMember)
+{
+  return aMember.found && !aMember.isAttribute && aMember.name == "next" &&
+    aMember.descriptor->inCount == 0 && aMember.descriptor->outCount == 0;
+}
+
+static PyObject*
+objectGetAttr(PyObject* aObj, char* aName)
+{
+  Object* object = reinterpret_cast<Object*>(aObj);
+  const ResolvedMember& rm = objectInterfaceSet(object)->findGettable(sCGS, aName);
+  if (!rm.found)
+  {
+    PyErr_Format(PyExc_ValueError, "%s: No such native CellML attribute or operation supported by object",
+                 aName);
+    return NULL;
+  }
+
+  iface::CGRS::ObjectValue* oobject = objectValue(object, sCGS);
+
+  if (rm.isAttribute)
+  {
+    std::vector<iface::CGRS::GenericValue*> inseq, outseq;
+    bool aWasException = false;
+    ObjRef<iface::CGRS::GenericValue> ret;
+    sNativeCalls++;
+    uint64_t start = sStatsEnabled ? nowNs() : 0;
+    {
+      ScopedTrace trace(tracing() ? memberTraceName(rm) : NULL, "getattr");
+      ScopedGILRelease nogil(releasesGIL(rm));
+      ret = rm.method->invoke(oobject, inseq, outseq, &aWasException);
+    }
+    if (start != 0)
+      memberStatsOf(rm)->getattr.record(start, aWasException);
+    if (aWasException)
+    {
+      PyErr_Format(PyExc_ValueError, "Exception raised by native CellML attribute getter %s on %s",
+                   aName, rm.interfaceName.c_str());
+      return NULL;
+    }
+    return genericValueToPython(ret);
   }
 
-  return NULL;
+  // We need to make a method object to return to Python...
+  Method* pymeth = sFreeMethods.alloc();
+  pymeth->mInvokeMethod = rm.method;
+  pymeth->mInvokeMethod->add_ref();
+  pymeth->mInvokeOn = oobject;
+  oobject->add_ref();
+  pymeth->mMember = &rm;
+  pymeth->mIterator = NULL;
+  if (isIteratorNext(rm))
+  {
+    Py_INCREF(aObj);
+    pymeth->mIterator = object;
+  }
+  return (PyObject*)pymeth;
 }
 
-static PyObject*
-genericValueToPythonS(iface::CGRS::GenericValue* aGenVal, const std::string& aTypename, iface::CGRS::GenericType* aGenType)
+static int
+objectSetAttr(PyObject* aObj, char* aName, PyObject* aValue)
 {
-  if (aTypename == "string")
+  Object* object = reinterpret_cast<Object*>(aObj);
+  const ResolvedMember& rm = objectInterfaceSet(object)->findSettable(sCGS, aName);
+  if (!rm.found)
+  {
+    PyErr_Format(PyExc_ValueError, "%s: No such native CellML setter",
+                 aName);
+    return 1;
+  }
+
+  iface::CGRS::ObjectValue* oobject = objectValue(object, sCGS);
+
+  ObjRef<iface::CGRS::GenericValue> arg(pythonToGenericValue(aValue, rm.type, rm.typeTag));
+  if (arg == NULL)
+    return 1;
+  std::vector<iface::CGRS::GenericValue*> inVec, outVec;
+  inVec.push_back(arg);
+  bool wasException = false;
+  sNativeCalls++;
+  uint64_t start = sStatsEnabled ? nowNs() : 0;
   {
-    DECLARE_QUERY_INTERFACE_OBJREF(sv, aGenVal, CGRS::StringValue);
-    std::string s(sv->asString());
-    return PyString_FromString(s.c_str());
+    ScopedTrace trace(tracing() ? memberTraceName(rm) : NULL, "setattr");
+    ScopedGILRelease nogil(releasesGIL(rm));
+    rm.method->invoke(oobject, inVec, outVec, &wasException)->release_ref();
   }
-  else if (aTypename == "short")
+  if (start != 0)
+    memberStatsOf(rm)->setattr.record(start, wasException);
+  if (wasException)
   {
-    DECLARE_QUERY_INTERFACE_OBJREF(sv, aGenVal, CGRS::ShortValue);
-    return PyInt_FromLong(sv->asShort());
+    PyErr_Format(PyExc_ValueError, "Exception raised while calling native CellML setter %s on interface %s",
+                 aName, rm.interfaceName.c_str());
+    return 1;
   }
+  return 0;
+}
 
-  // Maybe it is a sequence...
-  DECLARE_QUERY_INTERFACE_OBJREF(sv, aGenVal, CGRS::SequenceValue);
-  if (sv != NULL)
+static PyObject* objectGetIter(PyObject* aObject)
+{
+  PyObject* objNext = objectGetAttr(aObject, (char*)"iterate");
+  if (objNext == NULL)
+    return NULL;
+  PyObject* v = PyTuple_New(0);
+  PyObject* ret = PyObject_Call(objNext, v, NULL);
+  Py_DECREF(objNext);
+  Py_DECREF(v);
+  return ret;
+}
+
+// How many results of next() iterators fetch at a time; 0 or 1 fetches them
+// one at a time.
+static Py_ssize_t sIteratorBatch = 0;
+
+// Whether a value returned by next() is a null object (which CGRS may also
+// represent as a void value).
+static bool
+isNullObjectValue(iface::CGRS::GenericValue* aValue)
+{
+  DECLARE_QUERY_INTERFACE_OBJREF(ov, aValue, CGRS::ObjectValue);
+  if (ov == NULL)
+    return true;
+  ObjRef<iface::XPCOM::IObject> o(ov->asObject());
+  return o == NULL;
+}
+
+// Calls next() up to sIteratorBatch times without the GIL, stopping early at
+// the end of the iteration, and stores the converted results on aObject.
+static bool
+objectPrefetch(Object* aObject, const ResolvedMember& aNext)
+{
+  iface::CGRS::ObjectValue* oobject = objectValue(aObject, sCGS);
+  std::vector<iface::CGRS::GenericValue*> batch;
+  bool wasException = false;
+  // The whole batch is fetched in one crossing.
+  sNativeCalls++;
+  uint64_t start = sStatsEnabled ? nowNs() : 0;
   {
-    long l = sv->valueCount();
-    PyObject* lst = PyList_New(l);
-    for (long i = 0; i < l; i++)
+    ScopedTrace trace(tracing() ? memberTraceName(aNext) : NULL, "call");
+    ScopedGILRelease nogil(releasesGIL(aNext));
+    std::vector<iface::CGRS::GenericValue*> inseq, outseq;
+    while (static_cast<Py_ssize_t>(batch.size()) < sIteratorBatch)
     {
-      ObjRef<iface::CGRS::GenericValue> svi(sv->getValueByIndex(i));
-      PyList_SET_ITEM(lst, i, genericValueToPython(svi));
+      iface::CGRS::GenericValue* v = aNext.method->invoke(oobject, inseq, outseq, &wasException);
+      if (wasException)
+      {
+        if (v != NULL)
+          v->release_ref();
+        break;
+      }
+      batch.push_back(v);
+      if (isNullObjectValue(v))
+        break;
     }
-    return lst;
   }
+  if (start != 0)
+    memberStatsOf(aNext)->call.record(start, wasException);
 
-  return NULL;
-}
+  if (batch.empty())
+  {
+    PyErr_SetString(PyExc_ValueError, "Native CellML operation raised exception");
+    return false;
+  }
 
-static PyObject*
-genericValueToPythonU(iface::CGRS::GenericValue* aGenVal, const std::string& aTypename, iface::CGRS::GenericType* aGenType)
-{
-  if (aTypename == "unsigned short")
+  PyObject* lst = PyList_New(0);
+  if (lst == NULL)
   {
-    DECLARE_QUERY_INTERFACE_OBJREF(usv, aGenVal, CGRS::UShortValue);
-    return PyInt_FromLong(usv->asUShort());
+    for (size_t i = 0; i < batch.size(); i++)
+      batch[i]->release_ref();
+    return false;
   }
-  else if (aTypename == "unsigned long")
+
+  // Results after a failed conversion are dropped, and the error is kept to
+  // be raised in their place, as fetching them one at a time would have.
+  bool failed = false;
+  for (size_t i = 0; i < batch.size(); i++)
   {
-    DECLARE_QUERY_INTERFACE_OBJREF(ulv, aGenVal, CGRS::ULongValue);
-    return PyLong_FromUnsignedLong(ulv->asULong());
+    if (!failed)
+    {
+      PyObject* item = genericValueToPython(batch[i]);
+      // A NULL with nothing raised must still end the loop with an error,
+      // rather than looking like the end of the iteration.
+      if (item == NULL && !PyErr_Occurred())
+        PyErr_SetString(PyExc_TypeError, "Cannot convert a native CellML value to Python");
+      failed = item == NULL || PyList_Append(lst, item) != 0;
+      Py_XDECREF(item);
+    }
+    batch[i]->release_ref();
   }
-  else if (aTypename == "unsigned long long")
+  if (!failed && wasException)
   {
-    DECLARE_QUERY_INTERFACE_OBJREF(ullv, aGenVal, CGRS::ULongLongValue);
-    return PyLong_FromUnsignedLongLong(ullv->asULongLong());
+    PyErr_SetString(PyExc_ValueError, "Native CellML operation raised exception");
+    failed = true;
   }
 
-  return NULL;
+  Py_XDECREF(aObject->mPrefetched);
+  aObject->mPrefetched = lst;
+  aObject->mPrefetchPos = 0;
+  if (failed)
+    PyErr_Fetch(&aObject->mPrefetchErrorType, &aObject->mPrefetchErrorValue,
+                &aObject->mPrefetchErrorTraceback);
+  return true;
 }
 
+// Returns the next prefetched result of aObject (which must have some), or
+// raises the error that ended the batch once the results before it are gone.
 static PyObject*
-genericValueToPythonV(iface::CGRS::GenericValue* aGenVal, const std::string& aTypename, iface::CGRS::GenericType* aGenType)
+objectTakePrefetched(Object* aObject)
 {
-  if (aTypename == "void")
+  if (aObject->mPrefetchPos == PyList_GET_SIZE(aObject->mPrefetched))
   {
-    Py_RETURN_NONE;
+    Py_CLEAR(aObject->mPrefetched);
+    PyErr_Restore(aObject->mPrefetchErrorType, aObject->mPrefetchErrorValue,
+                  aObject->mPrefetchErrorTraceback);
+    aObject->mPrefetchErrorType = aObject->mPrefetchErrorValue = aObject->mPrefetchErrorTraceback = NULL;
+    return NULL;
   }
-  return NULL;
-}
 
-static void
-operator<<(std::ostream& data, const std::wstring& str)
-{
-  size_t n = wcstombs(NULL, str.c_str(), 0);
-  char* buf = new char[n + 1];
-  wcstombs(buf, str.c_str(), n + 1);
-  data << buf;
-  delete [] buf;
+  PyObject* ret = PyList_GET_ITEM(aObject->mPrefetched, aObject->mPrefetchPos++);
+  Py_INCREF(ret);
+  if (aObject->mPrefetchPos == PyList_GET_SIZE(aObject->mPrefetched) &&
+      aObject->mPrefetchErrorType == NULL)
+    Py_CLEAR(aObject->mPrefetched);
+  return ret;
 }
 
-static PyObject*
-genericValueToPythonW(iface::CGRS::GenericValue* aGenVal, const std::string& aTypename, iface::CGRS::GenericType* aGenType)
+static PyObject* objectIterNext(PyObject* aObject)
 {
-  if (aTypename == "wstring")
-  {
-    DECLARE_QUERY_INTERFACE_OBJREF(wsv, aGenVal, CGRS::WStringValue);
-    std::stringstream ss;
-    std::wstring ws(wsv->asWString());
-    ss << ws;
-    return PyString_FromString(ss.str().c_str());
-  }
-  return NULL;
-}
+  Object* object = reinterpret_cast<Object*>(aObject);
+  const ResolvedMember& rm = objectInterfaceSet(object)->findGettable(sCGS, "next");
 
-static PyObject* (*fastG2PTypeTable[])(iface::CGRS::GenericValue* aGenVal, const std::string& aTypeName, iface::CGRS::GenericType* aGenType) = {
-  /* a */ NULL,
-  /* b */ genericValueToPythonB,
-  /* c */ genericValueToPythonC,
-  /* d */ genericValueToPythonD,
-  /* e */ NULL,
-  /* f */ genericValueToPythonF,
-  /* g */ NULL,
-  /* h */ NULL,
-  /* i */ NULL,
-  /* j */ NULL,
-  /* k*/ NULL,
-  /* l */ genericValueToPythonL,
-  /* m */ NULL,
-  /* n */ NULL,
-  /* o */ genericValueToPythonO,
-  /* p */ NULL,
-  /* q */ NULL,
-  /* r */ NULL,
-  /* s */ genericValueToPythonS,
-  /* t */ NULL,
-  /* u */ genericValueToPythonU,
-  /* v */ genericValueToPythonV,
-  /* w */ genericValueToPythonW,
-  /* x */ NULL,
-  /* y */ NULL,
-  /* z */ NULL
-};
+  PyObject* ret;
+  if (!isIteratorNext(rm))
+  {
+    // Not something we can call directly; let objectGetAttr and methodCall
+    // report the problem.
+    PyObject* objNext = objectGetAttr(aObject, (char*)"next");
+    if (objNext == NULL)
+      return NULL;
 
-static void
-ObjectDealloc(Object* self)
-{
-  if (self->mObject != NULL)
-    self->mObject->release_ref();
-  self->ob_type->tp_free((PyObject*)self);
-}
+    PyObject* v = PyTuple_New(0);
+    ret = PyObject_Call(objNext, v, NULL);
+    Py_DECREF(v);
+    Py_DECREF(objNext);
+  }
+  else if (sIteratorBatch > 1 || object->mPrefetched != NULL)
+  {
+    if (object->mPrefetched == NULL && !objectPrefetch(object, rm))
+      return NULL;
+    ret = objectTakePrefetched(object);
+    if (ret == NULL)
+      return NULL;
+  }
+  else
+  {
+    std::vector<iface::CGRS::GenericValue*> inseq, outseq;
+    bool wasException = false;
+    ObjRef<iface::CGRS::GenericValue> v;
+    sNativeCalls++;
+    uint64_t start = sStatsEnabled ? nowNs() : 0;
+    {
+      ScopedTrace trace(tracing() ? memberTraceName(rm) : NULL, "call");
+      ScopedGILRelease nogil(releasesGIL(rm));
+      v = rm.method->invoke(objectValue(object, sCGS), inseq, outseq, &wasException);
+    }
+    if (start != 0)
+      memberStatsOf(rm)->call.record(start, wasException);
+    if (wasException)
+    {
+      PyErr_SetString(PyExc_ValueError, "Native CellML operation raised exception");
+      return NULL;
+    }
+    ret = genericValueToPython(v);
+  }
 
-static PyObject* Object_new(iface::XPCOM::IObject* aValue)
-{
-  Object* obj = PyObject_New(Object, &ObjectType);
-  obj->mObject = aValue;
-  obj->mObject->add_ref();
+  if (ret == Py_None)
+  {
+    Py_DECREF(ret);
+    return NULL;
+  }
 
-  return (PyObject*)obj;
+  return ret;
 }
 
-static void EnumDealloc(Enum* self)
+static int
+methodInit(Method* self, PyObject* args, PyObject* kwds)
 {
-  Py_CLEAR(self->asString);
-  self->ob_type->tp_free((PyObject*)self);
+  return 0;
 }
 
-static int EnumInit(Enum *self, PyObject *args, PyObject *kwds)
+static PyObject*
+methodNew(PyTypeObject *type, PyObject* args, PyObject* kwds)
 {
-  PyObject *asString = Py_None;
-
-  static const char *kwlist[] = {"asString", "asInteger", NULL};
+  Method *self;
+  self = (Method*)type->tp_alloc(type, 0);
 
-  if (! PyArg_ParseTupleAndKeywords(args, kwds, "|Si", const_cast<char**>(kwlist), 
-                                    &asString,
-                                    &self->asInteger))
-    return -1; 
+  self->mInvokeMethod = NULL;
+  self->mInvokeOn = NULL;
+  self->mMember = NULL;
+  self->mIterator = NULL;
 
-  self->asString = asString;
-  return 0;
+  return (PyObject*)self;
 }
 
-static PyObject *EnumNew(PyTypeObject *type, PyObject *args, PyObject *kwds)
+static void
+methodDealloc(Method* self)
 {
-  Enum *self;
-
-  self = (Enum*)type->tp_alloc(type, 0);
-  if (self != NULL)
-  {
-    self->asString = Py_None;
-    Py_INCREF(self->asString);
-    self->asInteger = -1;
-  }
-  
-  return (PyObject *)self;
+  if (self->mInvokeMethod != NULL)
+    self->mInvokeMethod->release_ref();
+  if (self->mInvokeOn != NULL)
+    self->mInvokeOn->release_ref();
+  Py_XDECREF(self->mIterator);
+  sFreeMethods.release(self);
 }
 
 static PyObject*
-genericValueToPython(iface::CGRS::GenericValue* aGenVal)
+methodCall(Method* self, PyObject* args, PyObject* kwds)
 {
-  // Check it isn't a Python implemented object...
-  DECLARE_QUERY_INTERFACE_OBJREF(cov, aGenVal, CGRS::CallbackObjectValue);
-
-  if (cov != NULL)
+  if (self->mInvokeMethod == NULL || self->mInvokeOn == NULL || self->mMember == NULL)
   {
-    PythonCallback* pycb = dynamic_cast<PythonCallback*>(static_cast<iface::CGRS::CallbackObjectValue*>(cov));
-    
-    if (pycb == NULL)
-    {
-      // We could support this case by making a wrapper that uses invokeOnInterface
-      // to allow Python to call into a foreign callback, but it is an obscure corner
-      // case in terms of the current API implementation, so lets just do this.
-      PyErr_SetString(PyExc_ValueError, "Cannot convert a CGRS callback that didn't come from cgrspy to a Python object - this has not been implemented because we are not sure anyone would use it. File a tracker item against the CellML API at https://tracker.physiomeproject.org/ if you have a legitimate reason to want this.");
-      return NULL;
-    }
-
-    return pycb->getObject();
+    PyErr_SetString(PyExc_ValueError, "cgrspy method not properly initialised");
+    return NULL;
   }
+  releasePendingDecrefs(NULL);
 
-  // It could be an enum...
-  DECLARE_QUERY_INTERFACE_OBJREF(ev, aGenVal, CGRS::EnumValue);
-  if (ev != NULL)
+  // Results already fetched by objectIterNext come before any new ones.
+  if (self->mIterator != NULL && self->mIterator->mPrefetched != NULL &&
+      PyTuple_GET_SIZE(args) == 0)
+    return objectTakePrefetched(self->mIterator);
+
+  const MethodDescriptor& desc = *self->mMember->descriptor;
+  Py_ssize_t nargsActual = PyTuple_GET_SIZE(args);
+  Py_ssize_t nargsExpected = desc.inCount;
+  if (nargsExpected != nargsActual)
   {
-    Enum *evo = PyObject_New(Enum, &EnumType);
-    std::string s(ev->asString());
-    evo->asString = PyString_FromString(s.c_str());
-    evo->asInteger = ev->asLong();
-    return reinterpret_cast<PyObject*>(evo);
+    PyErr_Format(PyExc_ValueError, "Native CellML operation expected %ld arguments, but %ld were given",
+                 nargsExpected, nargsActual);
+    return NULL;
   }
 
-  // Otherwise, it is one of the built-in types...
-  ObjRef<iface::CGRS::GenericType> gt(aGenVal->typeOfValue());
-  std::string n = gt->asString();
-  char c = n[0];
-  if (c < 'a' || c > 'z')
+  std::vector<iface::CGRS::GenericValue*> inVals, outVals;
+  inVals.reserve(desc.inCount);
+  for (size_t i = 0; i < desc.inCount; i++)
   {
-    if (n == "XPCOM::IObject")
+    iface::CGRS::GenericValue* gitem =
+      pythonToGenericValue(PyTuple_GET_ITEM(args, i), desc.inTypes[i], desc.inTags[i]);
+    if (gitem == NULL)
     {
-      DECLARE_QUERY_INTERFACE_OBJREF(obj, aGenVal, CGRS::ObjectValue);
-      ObjRef<iface::XPCOM::IObject> v(obj->asObject());
-      return Object_new(v);
-    }
-    else
+      for (std::vector<iface::CGRS::GenericValue*>::iterator i2 = inVals.begin();
+           i2 != inVals.end(); i2++)
+        (*i2)->release_ref();
       return NULL;
+    }
+    inVals.push_back(gitem);
   }
-  c -= 'a';
-  if (fastG2PTypeTable[(int)c] == NULL)
-    return NULL;
-  return fastG2PTypeTable[(int)c](aGenVal, n, gt);
-}
 
-static iface::CGRS::GenericValue*
-pythonValueToGenericB(PyObject* aPyVal, const std::string& aTypename, iface::CGRS::GenericType* aGenType)
-{
-  if (aTypename == "boolean")
+  bool wasException = false;
+  ObjRef<iface::CGRS::GenericValue> retval;
+  sNativeCalls++;
+  uint64_t start = sStatsEnabled ? nowNs() : 0;
   {
-    bool v = !!(PyInt_AsLong(aPyVal));
-    ObjRef<iface::CGRS::GenericsService> cgs(CreateGenericsService());
-    return cgs->makeBoolean(v);
+    ScopedTrace trace(tracing() ? memberTraceName(*self->mMember) : NULL, "call");
+    ScopedGILRelease nogil(releasesGIL(*self->mMember));
+    retval = self->mInvokeMethod->invoke(self->mInvokeOn, inVals, outVals, &wasException);
   }
+  if (start != 0)
+    memberStatsOf(*self->mMember)->call.record(start, wasException);
+  for (std::vector<iface::CGRS::GenericValue*>::iterator i = inVals.begin();
+       i != inVals.end(); i++)
+    (*i)->release_ref();
 
-  return NULL;
-}
-
-static iface::CGRS::GenericValue*
-pythonValueToGenericC(PyObject* aPyVal, const std::string& aTypename, iface::CGRS::GenericType* aGenType)
-{
-  if (aTypename == "char")
+  if (wasException)
   {
-    char * v = PyString_AsString(aPyVal);
-    if (v == NULL)
-      return NULL;
-    ObjRef<iface::CGRS::GenericsService> cgs(CreateGenericsService());
-    return cgs->makeChar(v[0]);
+    PyErr_SetString(PyExc_ValueError, "Native CellML operation raised exception");
+    for (std::vector<iface::CGRS::GenericValue*>::iterator i = outVals.begin();
+         i != outVals.end(); i++)
+      (*i)->release_ref();
+    return NULL;
   }
 
-  return NULL;
-}
+  if (outVals.empty())
+    return genericValueToPython(retval, desc.returnType, desc.returnTag);
 
-static iface::CGRS::GenericValue*
-pythonValueToGenericD(PyObject* aPyVal, const std::string& aTypename, iface::CGRS::GenericType* aGenType)
-{
-  if (aTypename == "double")
+  PyObject* tuple = PyTuple_New(outVals.size() + 1);
+  PyTuple_SetItem(tuple, 0, genericValueToPython(retval, desc.returnType, desc.returnTag));
+  size_t itemIndex = 1;
+  for (std::vector<iface::CGRS::GenericValue*>::iterator i = outVals.begin();
+       i != outVals.end(); i++)
   {
-    double v = PyFloat_AsDouble(aPyVal);
-    ObjRef<iface::CGRS::GenericsService> cgs(CreateGenericsService());
-    return cgs->makeDouble(v);
+    // Note: SetItem steals a reference, so we don't need to Py_DECREF...
+    PyTuple_SetItem(tuple, itemIndex++, genericValueToPython(*i));
+    (*i)->release_ref();
   }
 
-  return NULL;
+  return tuple;
 }
 
-static iface::CGRS::GenericValue*
-pythonValueToGenericF(PyObject* aPyVal, const std::string& aTypename, iface::CGRS::GenericType* aGenType)
+static PyObject *
+bootstrap_getBootstrap(PyObject *self, PyObject *args)
 {
-  if (aTypename == "float")
-  {
-    double v = PyFloat_AsDouble(aPyVal);
-    ObjRef<iface::CGRS::GenericsService> cgs(CreateGenericsService());
-    return cgs->makeFloat(static_cast<float>(v));
-  }
+  const char* bsname;
+  if (!PyArg_ParseTuple(args, "s", &bsname))
+    return NULL;
 
-  return NULL;
-}
+  ObjRef<iface::CGRS::GenericValue> gv;
 
-static iface::CGRS::GenericValue*
-pythonValueToGenericL(PyObject* aPyVal, const std::string& aTypename, iface::CGRS::GenericType* aGenType)
-{
-  if (aTypename == "long")
+  try
   {
-    int32_t v = PyInt_AsLong(aPyVal);
-    ObjRef<iface::CGRS::GenericsService> cgs(CreateGenericsService());
-    return cgs->makeLong(v);
-  }
-  else if (aTypename == "long long")
+    gv = sCGS->getBootstrapByName(bsname);
+  } catch (...) { /* Handled below... */}
+  if (gv == NULL)
   {
-    int64_t v = PyLong_AsLongLong(aPyVal);
-    ObjRef<iface::CGRS::GenericsService> cgs(CreateGenericsService());
-    return cgs->makeLongLong(v);
+    PyErr_Format(PyExc_LookupError, "Bootstrap %s could not be found", bsname);
+    return NULL;
   }
 
-  return NULL;
+  return genericValueToPython(gv);
 }
 
-static iface::CGRS::GenericValue*
-pythonValueToGenericO(PyObject* aPyVal, const std::string& aTypename, iface::CGRS::GenericType* aGenType)
+static PyObject*
+bootstrap_loadModule(PyObject* self, PyObject* args)
 {
-  if (aTypename == "octet")
+  PyEval_InitThreads();
+  const char* bspath;
+  if (!PyArg_ParseTuple(args, "s", &bspath))
+    return NULL;
+
+  try
+  {
+    sCGS->loadGenericModule(bspath);
+  }
+  catch (...)
   {
-    long v = PyInt_AsLong(aPyVal);
-    ObjRef<iface::CGRS::GenericsService> cgs(CreateGenericsService());
-    return cgs->makeOctet(static_cast<uint8_t>(v));
+    PyErr_Format(PyExc_IOError, "Cannot load module from path %s", bspath);
+    return NULL;
   }
+  InterfaceSet::sGeneration++;
 
-  return NULL;
+  Py_RETURN_NONE;
 }
 
-static iface::CGRS::GenericValue*
-pythonValueToGenericS(PyObject* aPyVal, const std::string& aTypename, iface::CGRS::GenericType* aGenType)
+static PyObject*
+bootstrap_setGILPolicy(PyObject* self, PyObject* args)
 {
-  if (aTypename == "string")
+  PyObject* release;
+  const char* ifname = NULL;
+  const char* membername = NULL;
+  if (!PyArg_ParseTuple(args, "O|zz", &release, &ifname, &membername))
+    return NULL;
+  int r = PyObject_IsTrue(release);
+  if (r == -1)
+    return NULL;
+
+  if (ifname == NULL)
   {
-    char* sb = PyString_AsString(aPyVal);
-    if (sb == NULL)
+    if (membername != NULL)
+    {
+      PyErr_SetString(PyExc_ValueError, "A member name needs an interface name");
       return NULL;
-    Py_ssize_t sl = PyString_Size(aPyVal);
-    std::string s(sb, sl);
-    ObjRef<iface::CGRS::GenericsService> cgs(CreateGenericsService());
-    return cgs->makeString(s);
-  }
-  else if (aTypename == "short")
-  {
-    long v = PyInt_AsLong(aPyVal);
-    ObjRef<iface::CGRS::GenericsService> cgs(CreateGenericsService());
-    return cgs->makeShort(static_cast<int16_t>(v));
+    }
+    sDefaultReleaseGIL = !!r;
   }
-
-  // Maybe it is a sequence...
-  DECLARE_QUERY_INTERFACE_OBJREF(st, aGenType, CGRS::SequenceType);
-  if (st != NULL)
+  else
   {
-    Py_ssize_t l = PySequence_Length(aPyVal);
-    if (l == -1)
-      return NULL;
-
-    ObjRef<iface::CGRS::GenericsService> cgs(CreateGenericsService());
-    ObjRef<iface::CGRS::GenericType> innerType(st->innerType());
-    ObjRef<iface::CGRS::SequenceValue> sv(cgs->makeSequence(innerType));
-    for (Py_ssize_t i = 0; i < l; i++)
+    std::string key(ifname);
+    if (membername != NULL)
     {
-      PyObject* pyItem = PySequence_GetItem(aPyVal, i);
-      ObjRef<iface::CGRS::GenericValue> gitem = pythonToGenericValue(pyItem, innerType);
-      Py_DECREF(pyItem);
-      if (gitem == NULL)
-        return NULL;
-
-      sv->appendValue(gitem);
+      key += '\n';
+      key += membername;
     }
+    sGILPolicies[key] = !!r;
+  }
+  sGILPolicyGeneration++;
+
+  Py_RETURN_NONE;
+}
 
-    sv->add_ref();
-    return sv;
-  }
+static PyObject*
+bootstrap_setNumericArrays(PyObject* self, PyObject* args)
+{
+  PyObject* enable;
+  if (!PyArg_ParseTuple(args, "O", &enable))
+    return NULL;
+  int r = PyObject_IsTrue(enable);
+  if (r == -1)
+    return NULL;
+  sNumericArrays = !!r;
 
-  return NULL;
+  Py_RETURN_NONE;
 }
 
-static iface::CGRS::GenericValue*
-pythonValueToGenericU(PyObject* aPyVal, const std::string& aTypename, iface::CGRS::GenericType* aGenType)
+static PyObject*
+bootstrap_setStringInterning(PyObject* self, PyObject* args)
 {
-  if (aTypename == "unsigned short")
-  {
-    long v = PyInt_AsLong(aPyVal);
-    ObjRef<iface::CGRS::GenericsService> cgs(CreateGenericsService());
-    return cgs->makeUShort(static_cast<uint16_t>(v));
-  }
-  else if (aTypename == "unsigned long")
-  {
-    long long v = PyLong_AsLongLong(aPyVal);
-    ObjRef<iface::CGRS::GenericsService> cgs(CreateGenericsService());
-    return cgs->makeULong(static_cast<uint32_t>(v));
-  }
-  else if (aTypename == "unsigned long long")
+  Py_ssize_t maxLength, capacity = 4096;
+  if (!PyArg_ParseTuple(args, "n|n", &maxLength, &capacity))
+    return NULL;
+  if (maxLength < 0 || capacity < 1)
   {
-    long long v = PyLong_AsLongLong(aPyVal);
-    ObjRef<iface::CGRS::GenericsService> cgs(CreateGenericsService());
-    return cgs->makeULongLong(static_cast<uint64_t>(v));
+    PyErr_SetString(PyExc_ValueError, "The length cannot be negative and the capacity must be positive");
+    return NULL;
   }
+  clearInternedStrings();
+  sInternMaxLength = maxLength;
+  sInternCapacity = capacity;
 
-  return NULL;
+  Py_RETURN_NONE;
 }
 
-static iface::CGRS::GenericValue*
-pythonValueToGenericV(PyObject* aPyVal, const std::string& aTypename, iface::CGRS::GenericType* aGenType)
+static PyObject*
+bootstrap_setIteratorPrefetch(PyObject* self, PyObject* args)
 {
-  if (aTypename == "void")
+  Py_ssize_t batch;
+  if (!PyArg_ParseTuple(args, "n", &batch))
+    return NULL;
+  if (batch < 0)
   {
-    ObjRef<iface::CGRS::GenericsService> cgs(CreateGenericsService());
-    return cgs->makeVoid();
+    PyErr_SetString(PyExc_ValueError, "The batch size cannot be negative");
+    return NULL;
   }
-  return NULL;
+  sIteratorBatch = batch;
+
+  Py_RETURN_NONE;
 }
 
-static iface::CGRS::GenericValue*
-pythonValueToGenericW(PyObject* aPyVal, const std::string& aTypename, iface::CGRS::GenericType* aGenType)
+static PyObject*
+bootstrap_allocationStats(PyObject* self, PyObject* args)
 {
-  if (aTypename == "wstring")
-  {
-    if (PyUnicode_Check(aPyVal))
-      Py_INCREF(aPyVal);
-    else
-      aPyVal = PyUnicode_FromObject(aPyVal);
-
-    if (aPyVal == NULL)
-      return NULL;
+  return Py_BuildValue("{s:N,s:N,s:N}", "Object", sFreeObjects.stats(),
+                       "Method", sFreeMethods.stats(), "Enum", sFreeEnums.stats());
+}
 
-    Py_ssize_t sl = PyUnicode_GetSize(aPyVal);
-    if (PyErr_Occurred())
-    {
-      Py_DECREF(aPyVal);
-      return NULL;
-    }
+static PyObject*
+bootstrap_crossingCounts(PyObject* self, PyObject* args)
+{
+  return Py_BuildValue("{s:K,s:K}", "native", sNativeCalls, "python", sPythonCalls);
+}
 
-    wchar_t buf[sl + 1];
-    PyUnicode_AsWideChar(reinterpret_cast<PyUnicodeObject*>(aPyVal), buf, sl);
+static PyObject*
+bootstrap_setStats(PyObject* self, PyObject* args)
+{
+  PyObject* enable;
+  if (!PyArg_ParseTuple(args, "O", &enable))
+    return NULL;
+  int r = PyObject_IsTrue(enable);
+  if (r == -1)
+    return NULL;
+  sStatsEnabled = !!r;
 
-    Py_DECREF(aPyVal);
+  Py_RETURN_NONE;
+}
 
-    std::wstring s(buf, sl);
-    ObjRef<iface::CGRS::GenericsService> cgs(CreateGenericsService());
-    return cgs->makeWString(s);
+static PyObject*
+bootstrap_stats(PyObject* self, PyObject* args)
+{
+  static const char* kinds[] = {"getattr", "setattr", "call", "callback"};
+  PyObject* members = PyDict_New();
+  for (std::unordered_map<std::string, std::unordered_map<std::string, MemberStats> >::iterator
+         i = sMemberStats.begin(); i != sMemberStats.end(); i++)
+  {
+    PyObject* ifaceMembers = PyDict_New();
+    for (std::unordered_map<std::string, MemberStats>::iterator j = i->second.begin();
+         j != i->second.end(); j++)
+    {
+      const MemberStats& ms = j->second;
+      const CallStats* calls[] = {&ms.getattr, &ms.setattr, &ms.call, &ms.callback};
+      PyObject* d = PyDict_New();
+      for (int k = 0; k < 4; k++)
+      {
+        if (calls[k]->count == 0)
+          continue;
+        PyObject* cs = calls[k]->toPython();
+        PyDict_SetItemString(d, kinds[k], cs);
+        Py_DECREF(cs);
+      }
+      if (ms.swallowed != 0)
+      {
+        PyObject* n = PyLong_FromUnsignedLongLong(ms.swallowed);
+        PyDict_SetItemString(d, "swallowed", n);
+        Py_DECREF(n);
+      }
+      if (PyDict_Size(d) != 0)
+        PyDict_SetItemString(ifaceMembers, j->first.c_str(), d);
+      Py_DECREF(d);
+    }
+    if (PyDict_Size(ifaceMembers) != 0)
+      PyDict_SetItemString(members, i->first.c_str(), ifaceMembers);
+    Py_DECREF(ifaceMembers);
   }
 
-  return NULL;
+  return Py_BuildValue("{s:O,s:N,s:{s:N,s:N},s:{s:N,s:N,s:N}}",
+                       "enabled", sStatsEnabled ? Py_True : Py_False,
+                       "members", members,
+                       "conversions", "toPython", conversionStats(0),
+                       "toNative", conversionStats(1),
+                       "allocations", "Object", sFreeObjects.stats(),
+                       "Method", sFreeMethods.stats(), "Enum", sFreeEnums.stats());
 }
 
-static iface::CGRS::GenericValue* (*fastP2GTypeTable[])(PyObject* aPyVal, const std::string& aTypeName, iface::CGRS::GenericType* aGenType) = {
-  /* a */ NULL,
-  /* b */ pythonValueToGenericB,
-  /* c */ pythonValueToGenericC,
-  /* d */ pythonValueToGenericD,
-  /* e */ NULL,
-  /* f */ pythonValueToGenericF,
-  /* g */ NULL,
-  /* h */ NULL,
-  /* i */ NULL,
-  /* j */ NULL,
-  /* k*/ NULL,
-  /* l */ pythonValueToGenericL,
-  /* m */ NULL,
-  /* n */ NULL,
-  /* o */ pythonValueToGenericO,
-  /* p */ NULL,
-  /* q */ NULL,
-  /* r */ NULL,
-  /* s */ pythonValueToGenericS,
-  /* t */ NULL,
-  /* u */ pythonValueToGenericU,
-  /* v */ pythonValueToGenericV,
-  /* w */ pythonValueToGenericW,
-  /* x */ NULL,
-  /* y */ NULL,
-  /* z */ NULL
-};
+static PyObject*
+bootstrap_resetStats(PyObject* self, PyObject* args)
+{
+  for (std::unordered_map<std::string, std::unordered_map<std::string, MemberStats> >::iterator
+         i = sMemberStats.begin(); i != sMemberStats.end(); i++)
+    for (std::unordered_map<std::string, MemberStats>::iterator j = i->second.begin();
+         j != i->second.end(); j++)
+      j->second.reset();
+  memset(sConversions, 0, sizeof(sConversions));
+  sFreeObjects.resetStats();
+  sFreeMethods.resetStats();
+  sFreeEnums.resetStats();
 
-static already_AddRefd<iface::CGRS::GenericValue>
-pythonToGenericValue(PyObject* aObj, iface::CGRS::GenericType* aType)
+  Py_RETURN_NONE;
+}
+
+static PyObject*
+bootstrap_setTracing(PyObject* self, PyObject* args)
 {
-  ObjRef<iface::CGRS::GenericsService> cgs(CreateGenericsService());
-  std::string n = aType->asString();
-  if (n == "XPCOM::IObject")
+  PyObject* enable;
+  Py_ssize_t capacity = 65536;
+  if (!PyArg_ParseTuple(args, "O|n", &enable, &capacity))
+    return NULL;
+  int r = PyObject_IsTrue(enable);
+  if (r == -1)
+    return NULL;
+  if (capacity < 1)
   {
-    // See if aObj is a wrapped native object...
-    if (PyObject_TypeCheck(aObj, &ObjectType))
-      return cgs->makeObject((reinterpret_cast<Object*>(aObj))->mObject);
-
-    // aObj is a Python object - wrap it in a callback.
-    return new PythonCallback(aObj);
+    PyErr_SetString(PyExc_ValueError, "The capacity must be positive");
+    return NULL;
   }
-  
-  // It could be an enum...
-  DECLARE_QUERY_INTERFACE_OBJREF(et, aType, CGRS::EnumType);
-  if (et != NULL)
+
+  if (r)
   {
-    PyObject* iv = PyObject_GetAttrString(aObj, "asInteger");
-    if (iv != NULL)
+    sTraceCapacity.store(capacity, std::memory_order_relaxed);
+    sTraceGeneration.fetch_add(1, std::memory_order_release);
+    // The events of threads that have exited belong to the trace just ended.
+    for (TraceBuffer* b = sTraceBuffers.load(std::memory_order_acquire); b != NULL; b = b->next)
     {
-      PyErr_Clear();
-      long idx = PyInt_AsLong(iv);
-      Py_DECREF(iv);
-      if (!PyErr_Occurred())
-        return cgs->makeEnumFromIndex(et, idx);
+      bool owned = false;
+      if (b->owned.load(std::memory_order_relaxed) ||
+          !b->owned.compare_exchange_strong(owned, true, std::memory_order_acquire))
+        continue;
+      delete [] b->events;
+      b->events = NULL;
+      b->capacity = 0;
+      b->owned.store(false, std::memory_order_release);
     }
-    PyErr_Clear();
-
-    iv = PyObject_GetAttrString(aObj, "asString");
-    if (!iv)
-      return NULL;
-    char* str = PyString_AsString(iv);
-    iface::CGRS::GenericValue* gv = NULL;
-    if (str != NULL)
-      gv = cgs->makeEnumFromString(et, str);
-    Py_DECREF(iv);
-    return gv;
   }
+  sTracing.store(!!r, std::memory_order_relaxed);
 
-  // Our type should be a built-in type...
-  char c = n[0];
-  if (c < 'a' || c > 'z')
-    return NULL; // Shouldn't happen.
-  c -= 'a';
-  if (fastP2GTypeTable[(int)c] == NULL)
-    return NULL;
-  return fastP2GTypeTable[(int)c](aObj, n, aType);
+  Py_RETURN_NONE;
+}
+
+// Writes aName as a JSON string.
+static void
+writeJSONString(FILE* aFile, const char* aName)
+{
+  fputc('"', aFile);
+  for (; *aName; aName++)
+  {
+    unsigned char c = *aName;
+    if (c == '"' || c == '\\')
+      fprintf(aFile, "\\%c", c);
+    else if (c < 0x20)
+      fprintf(aFile, "\\u%04x", c);
+    else
+      fputc(c, aFile);
+  }
+  fputc('"', aFile);
 }
 
 static PyObject*
-objectGetAttr(PyObject* aObj, char* aName)
+bootstrap_dumpTrace(PyObject* self, PyObject* args)
 {
-  iface::XPCOM::IObject* object = reinterpret_cast<Object*>(aObj)->mObject;
-  ObjRef<iface::CGRS::GenericsService> cgs(CreateGenericsService());
-  ObjRef<iface::CGRS::GenericValue> gobject(cgs->makeObject(object));
-  DECLARE_QUERY_INTERFACE_OBJREF(oobject, gobject, CGRS::ObjectValue);
+  const char* path;
+  if (!PyArg_ParseTuple(args, "s", &path))
+    return NULL;
 
-  std::vector<std::string> v(object->supported_interfaces());
-  for (std::vector<std::string>::iterator i = v.begin(); i != v.end(); i++)
+  FILE* f = fopen(path, "w");
+  if (f == NULL)
+    return PyErr_SetFromErrnoWithFilename(PyExc_IOError, const_cast<char*>(path));
+
+  // Threads only start a new trace after setTracing, which needs the GIL that
+  // we hold, so the buffers of the current trace only grow while we read them.
+  unsigned long generation = sTraceGeneration.load(std::memory_order_relaxed);
+  long pid = getpid();
+  long written = 0;
+  unsigned long long dropped = 0;
+  fputs("{\"traceEvents\":[", f);
+  for (TraceBuffer* b = sTraceBuffers.load(std::memory_order_acquire); b != NULL; b = b->next)
   {
-    ObjRef<iface::CGRS::GenericInterface> iface;
-    try { iface = cgs->getInterfaceByName(*i); } catch (...) {}
-    if (iface == NULL)
+    if (b->generation.load(std::memory_order_acquire) != generation)
       continue;
-    ObjRef<iface::CGRS::GenericAttribute> at;
-    try { at = iface->getAttributeByName(aName); } catch (...) {}
-    if (at != NULL)
-    {
-      ObjRef<iface::CGRS::GenericMethod> meth(at->getter());
-      std::vector<iface::CGRS::GenericValue*> inseq, outseq;
-      bool aWasException = false;
-      ObjRef<iface::CGRS::GenericValue> ret(meth->invoke(oobject, inseq, outseq, &aWasException));
-      if (aWasException)
-      {
-        PyErr_Format(PyExc_ValueError, "Exception raised by native CellML attribute getter %s on %s",
-                     aName, (*i).c_str());
-        return NULL;
-      }
-      return genericValueToPython(ret);
-    }
-
-    ObjRef<iface::CGRS::GenericMethod> meth;
-    try { meth = iface->getOperationByName(aName); } catch (...) {}
-
-    if (meth != NULL)
+    size_t count = b->count.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; i++)
     {
-      // We need to make a method object to return to Python...
-      Method* pymeth = PyObject_New(Method, &MethodType);
-      pymeth->mInvokeMethod = meth;
-      meth->add_ref();
-      pymeth->mInvokeOn = oobject;
-      oobject->add_ref();
-      return (PyObject*)pymeth;
+      const TraceEvent& e = b->events[i];
+      fputs(written++ == 0 ? "\n{\"name\":" : ",\n{\"name\":", f);
+      writeJSONString(f, e.name);
+      fprintf(f, ",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":%ld,\"tid\":%ld}",
+              e.category, e.phase, e.time / 1000.0, pid, b->thread);
     }
+    dropped += b->dropped.load(std::memory_order_relaxed);
   }
+  fprintf(f, "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped\":%llu}}\n", dropped);
 
-  PyErr_Format(PyExc_ValueError, "%s: No such native CellML attribute or operation supported by object",
-               aName);
-  return NULL;
+  if (fclose(f) != 0)
+    return PyErr_SetFromErrnoWithFilename(PyExc_IOError, const_cast<char*>(path));
+  return PyInt_FromLong(written);
 }
 
-static int
-objectSetAttr(PyObject* aObj, char* aName, PyObject* aValue)
+static PyObject*
+bootstrap_setAsyncCallback(PyObject* self, PyObject* args)
 {
-  iface::XPCOM::IObject* object = reinterpret_cast<Object*>(aObj)->mObject;
-  ObjRef<iface::CGRS::GenericsService> cgs(CreateGenericsService());
-  ObjRef<iface::CGRS::GenericValue> gobject(cgs->makeObject(object));
-  DECLARE_QUERY_INTERFACE_OBJREF(oobject, gobject, CGRS::ObjectValue);
+  const char* ifname;
+  const char* membername;
+  PyObject* enable = Py_True;
+  if (!PyArg_ParseTuple(args, "ss|O", &ifname, &membername, &enable))
+    return NULL;
+  int r = PyObject_IsTrue(enable);
+  if (r == -1)
+    return NULL;
 
-  std::vector<std::string> v(object->supported_interfaces());
-  for (std::vector<std::string>::iterator i = v.begin(); i != v.end(); i++)
+  if (r)
   {
-    ObjRef<iface::CGRS::GenericInterface> iface;
-    try { iface = (cgs->getInterfaceByName(*i)); } catch (...) {}
-    if (iface == NULL)
-      continue;
-    ObjRef<iface::CGRS::GenericAttribute> at;
-    try { at = iface->getAttributeByName(aName); } catch (...) {}
-    if (at != NULL)
+    // Only calls that return nothing can be answered before Python runs.
+    bool found = false;
+    for (int hasArguments = 0; hasArguments < 2; hasArguments++)
     {
-      if (at->isReadonly())
+      const CallbackMember* cm = findCallbackMember(ifname, membername, hasArguments);
+      if (!cm->found)
         continue;
-
-      ObjRef<iface::CGRS::GenericType> t(at->type());
-      ObjRef<iface::CGRS::GenericMethod> meth(at->setter());
-      ObjRef<iface::CGRS::GenericValue> arg(pythonToGenericValue(aValue, t));
-      if (arg == NULL)
-        return 1;
-      std::vector<iface::CGRS::GenericValue*> inVec, outVec;
-      inVec.push_back(arg);
-      bool wasException = false;
-      meth->invoke(oobject, inVec, outVec, &wasException)->release_ref();
-      if (wasException)
+      found = true;
+      if (cm->descriptor->returnTag != TYPE_VOID || cm->descriptor->outCount != 0)
       {
-        PyErr_Format(PyExc_ValueError, "Exception raised while calling native CellML setter %s on interface %s",
-                     aName, (*i).c_str());
-        return 1;
+        PyErr_Format(PyExc_ValueError, "%s on %s returns values, so cannot be delivered asynchronously",
+                     membername, ifname);
+        return NULL;
       }
-      return 0;
+    }
+    if (!found)
+    {
+      PyErr_Format(PyExc_ValueError, "%s: No such member of interface %s", membername, ifname);
+      return NULL;
     }
   }
 
-  PyErr_Format(PyExc_ValueError, "%s: No such native CellML setter",
-               aName);
-  return 1;
+  const AsyncMemberMap* old = sAsyncMembers.load(std::memory_order_acquire);
+  AsyncMemberMap* members = old == NULL ? new AsyncMemberMap() : new AsyncMemberMap(*old);
+  if (r)
+    (*members)[ifname].insert(membername);
+  else
+    (*members)[ifname].erase(membername);
+  sAsyncMembers.store(members, std::memory_order_release);
+
+  Py_RETURN_NONE;
 }
 
-static PyObject* objectGetIter(PyObject* aObject)
+static PyObject*
+bootstrap_deliverCallbacks(PyObject* self, PyObject* args)
 {
-  PyObject* objNext = objectGetAttr(aObject, (char*)"iterate");
-  if (objNext == NULL)
-    return NULL;
-  PyObject* v = PyTuple_New(0);
-  PyObject* ret = PyObject_Call(objNext, v, NULL);
-  Py_DECREF(objNext);
-  Py_DECREF(v);
-  return ret;
+  return PyInt_FromLong(deliverAllQueuedCallbacks());
 }
 
-static PyObject* objectIterNext(PyObject* aObject)
+static PyObject*
+bootstrap_createResultRecorder(PyObject* self, PyObject* args)
 {
-  PyObject* objNext = objectGetAttr(aObject, (char*)"next");
-  if (objNext == NULL)
+  Py_ssize_t rowLength, capacity = 0;
+  if (!PyArg_ParseTuple(args, "n|n", &rowLength, &capacity))
     return NULL;
-
-  PyObject* v = PyTuple_New(0);
-  PyObject* ret = PyObject_Call(objNext, v, NULL);
-  Py_DECREF(v);
-  Py_DECREF(objNext);
-
-  if (ret == Py_None)
+  if (rowLength < 1 || capacity < 0)
   {
-    Py_DECREF(ret);
+    PyErr_SetString(PyExc_ValueError, "The row length must be positive and the capacity not negative");
+    return NULL;
+  }
+  // Buffer views give the size of the rows in a Py_ssize_t.
+  if (static_cast<size_t>(rowLength) > PY_SSIZE_T_MAX / sizeof(double))
+  {
+    PyErr_SetString(PyExc_ValueError, "The row length is too large");
     return NULL;
   }
+  if (static_cast<size_t>(capacity) > PY_SSIZE_T_MAX / sizeof(double) / rowLength)
+    return PyErr_NoMemory();
 
-  return ret;
+  Observer* rec = PyObject_New(Observer, &RecorderType);
+  if (rec == NULL)
+    return NULL;
+  rec->mObserver = new ResultRecorder(rowLength, capacity);
+  if (capacity != 0 && !recorderOf(rec)->allocateRing(capacity))
+  {
+    Py_DECREF(rec);
+    return PyErr_NoMemory();
+  }
+  return (PyObject*)rec;
 }
 
-static int
-methodInit(Method* self, PyObject* args, PyObject* kwds)
+// Gets aObject.aName as an integer. Returns false, with an exception set, if
+// that fails.
+static bool
+getLongAttr(PyObject* aObject, const char* aName, long& aValue)
 {
-  return 0;
+  PyObject* v = PyObject_GetAttrString(aObject, aName);
+  if (v == NULL)
+    return false;
+  aValue = PyInt_AsLong(v);
+  Py_DECREF(v);
+  return aValue != -1 || !PyErr_Occurred();
 }
 
-static PyObject*
-methodNew(PyTypeObject *type, PyObject* args, PyObject* kwds)
+// Gets aObject.aName.aSubName, which must be a string, into aValue.
+static bool
+getStringAttr(PyObject* aObject, const char* aName, const char* aSubName, std::string& aValue)
 {
-  Method *self;
-  self = (Method*)type->tp_alloc(type, 0);
-
-  self->mInvokeMethod = NULL;
-  self->mInvokeOn = NULL;
-
-  return (PyObject*)self;
+  PyObject* v = PyObject_GetAttrString(aObject, aName);
+  if (v == NULL)
+    return false;
+  PyObject* sv = PyObject_GetAttrString(v, aSubName);
+  Py_DECREF(v);
+  if (sv == NULL)
+    return false;
+  const char* str = PyString_AsString(sv);
+  if (str != NULL)
+    aValue = str;
+  Py_DECREF(sv);
+  return str != NULL;
 }
 
-static void
-methodDealloc(Method* self)
+// Names the column holding the computation target aTarget, if it has one.
+static bool
+nameTargetColumn(PyObject* aTarget, long aRateCount, std::vector<ColumnarColumn>& aColumns)
 {
-  if (self->mInvokeMethod != NULL)
-    self->mInvokeMethod->release_ref();
-  if (self->mInvokeOn != NULL)
-    self->mInvokeOn->release_ref();
-  self->ob_type->tp_free((PyObject*)self);
+  long degree, index;
+  std::string type;
+  if (!getLongAttr(aTarget, "degree", degree) || !getLongAttr(aTarget, "assignedIndex", index) ||
+      !getStringAttr(aTarget, "type", "asString", type))
+    return false;
+
+  // The highest derivative of a state variable is assigned a rate.
+  long column = -1;
+  if (type == "VARIABLE_OF_INTEGRATION")
+    column = 0;
+  else if (type == "STATE_VARIABLE")
+    column = 1 + (degree == 0 ? 0 : aRateCount) + index;
+  else if (type == "ALGEBRAIC")
+    column = 1 + 2 * aRateCount + index;
+  if (column < 0 || column >= static_cast<long>(aColumns.size()))
+    return true;
+
+  std::string name;
+  if (!getStringAttr(aTarget, "variable", "name", name))
+    return false;
+  strncpy(aColumns[column].name, name.c_str(), sizeof(aColumns[column].name) - 1);
+  return true;
 }
 
-static PyObject*
-methodCall(Method* self, PyObject* args, PyObject* kwds)
+// Lays the columns out in the order the integration service reports results,
+// from the computation targets of the codeInformation object aCodeInfo.
+static bool
+columnarLayout(PyObject* aCodeInfo, ColumnarHeader& aHeader, std::vector<ColumnarColumn>& aColumns)
 {
-  if (self->mInvokeMethod == NULL || self->mInvokeOn == NULL)
+  long rates, algebraics;
+  if (!getLongAttr(aCodeInfo, "rateIndexCount", rates) ||
+      !getLongAttr(aCodeInfo, "algebraicIndexCount", algebraics))
+    return false;
+  if (rates < 0 || algebraics < 0)
   {
-    PyErr_SetString(PyExc_ValueError, "cgrspy method not properly initialised");
-    return NULL;
+    PyErr_SetString(PyExc_ValueError, "The codeInformation has negative index counts");
+    return false;
   }
+  aHeader.rateCount = rates;
+  aHeader.algebraicCount = algebraics;
 
-  Py_ssize_t nargsActual = PySequence_Size(args);
-
-  std::vector<iface::CGRS::GenericValue*> inVals, outVals;
-  std::vector<iface::CGRS::GenericParameter*> parSeq(self->mInvokeMethod->parameters());
-
-  Py_ssize_t nargsExpected = 0;
-  for (std::vector<iface::CGRS::GenericParameter*>::iterator i = parSeq.begin();
-       i != parSeq.end(); i++)
-  {
-    if ((*i)->isIn())
-      nargsExpected++;
-  }
-  if (nargsExpected != nargsActual)
+  aColumns.resize(1 + 2 * rates + algebraics);
+  for (long c = 0; c < static_cast<long>(aColumns.size()); c++)
   {
-    for (std::vector<iface::CGRS::GenericParameter*>::iterator i = parSeq.begin();
-         i != parSeq.end(); i++)
-      (*i)->release_ref();
-    PyErr_Format(PyExc_ValueError, "Native CellML operation expected %ld arguments, but %ld were given",
-                 nargsExpected, nargsActual);
-    return NULL;
+    memset(&aColumns[c], 0, sizeof(ColumnarColumn));
+    if (c == 0)
+      aColumns[c].kind = COLUMN_VARIABLE_OF_INTEGRATION;
+    else if (c <= rates)
+    {
+      aColumns[c].kind = COLUMN_STATE_VARIABLE;
+      aColumns[c].index = c - 1;
+    }
+    else if (c <= 2 * rates)
+    {
+      aColumns[c].kind = COLUMN_RATE;
+      aColumns[c].index = c - 1 - rates;
+    }
+    else
+    {
+      aColumns[c].kind = COLUMN_ALGEBRAIC;
+      aColumns[c].index = c - 1 - 2 * rates;
+    }
   }
 
-  size_t itemIndex = 0;
-  for (std::vector<iface::CGRS::GenericParameter*>::iterator i = parSeq.begin();
-       i != parSeq.end(); i++)
+  PyObject* targets = PyObject_CallMethod(aCodeInfo, const_cast<char*>("iterateTargets"), NULL);
+  if (targets == NULL)
+    return false;
+  bool ok = true;
+  while (ok)
   {
-    if ((*i)->isIn())
+    PyObject* ct = PyObject_CallMethod(targets, const_cast<char*>("nextComputationTarget"), NULL);
+    if (ct == NULL)
+      ok = false;
+    else if (ct == Py_None)
     {
-      PyObject* item = PySequence_GetItem(args, itemIndex);
-      itemIndex++;
-      ObjRef<iface::CGRS::GenericType> pt = (*i)->type();
-      iface::CGRS::GenericValue* gitem = pythonToGenericValue(item, pt);
-      Py_DECREF(item);
-      if (gitem == NULL)
-      {
-        for (std::vector<iface::CGRS::GenericParameter*>::iterator i2 = parSeq.begin();
-             i2 != parSeq.end(); i2++)
-          (*i2)->release_ref();
-        for (std::vector<iface::CGRS::GenericValue*>::iterator i2 = inVals.begin();
-             i2 != inVals.end(); i2++)
-          (*i2)->release_ref();
-        return NULL;
-      }
-      inVals.push_back(gitem);
+      Py_DECREF(ct);
+      break;
+    }
+    else
+    {
+      ok = nameTargetColumn(ct, rates, aColumns);
+      Py_DECREF(ct);
     }
   }
+  Py_DECREF(targets);
+  return ok;
+}
 
-  for (std::vector<iface::CGRS::GenericParameter*>::iterator i = parSeq.begin();
-       i != parSeq.end(); i++)
-    (*i)->release_ref();
-
-  bool wasException = false;
-  ObjRef<iface::CGRS::GenericValue> retval(self->mInvokeMethod->invoke(self->mInvokeOn, inVals, outVals, &wasException));
-  for (std::vector<iface::CGRS::GenericValue*>::iterator i = inVals.begin();
-       i != inVals.end(); i++)
-    (*i)->release_ref();
-  
-  if (wasException)
+static PyObject*
+bootstrap_createColumnarSink(PyObject* self, PyObject* args)
+{
+  const char* path;
+  PyObject* layout;
+  Py_ssize_t expectedRows = 0;
+  if (!PyArg_ParseTuple(args, "sO|n", &path, &layout, &expectedRows))
+    return NULL;
+  if (expectedRows < 0)
   {
-    PyErr_SetString(PyExc_ValueError, "Native CellML operation raised exception");
-    for (std::vector<iface::CGRS::GenericValue*>::iterator i = outVals.begin();
-         i != outVals.end(); i++)
-      (*i)->release_ref();
+    PyErr_SetString(PyExc_ValueError, "The expected number of rows cannot be negative");
     return NULL;
   }
 
-  std::list<iface::CGRS::GenericValue*> outList;
-  outList.push_back(retval);
-  outList.insert(outList.end(), outVals.begin(), outVals.end());
-  retval->add_ref();
+  ColumnarHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kColumnarMagic, sizeof(header.magic));
+  header.version = kColumnarVersion;
+  header.status = COLUMNAR_RUNNING;
 
-  ObjRef<iface::CGRS::GenericsService> cgs(CreateGenericsService());
-
-  if (outList.size() == 1)
+  std::vector<ColumnarColumn> columns;
+  if (PyInt_Check(layout) || PyLong_Check(layout))
   {
-    ObjRef<iface::CGRS::GenericValue> rv(already_AddRefd<iface::CGRS::GenericValue>(outList.front()));
-    return genericValueToPython(rv);
+    // Just a column count, with nothing known about the columns.
+    Py_ssize_t count = PyInt_AsSsize_t(layout);
+    if (count == -1 && PyErr_Occurred())
+      return NULL;
+    if (count < 1)
+    {
+      PyErr_SetString(PyExc_ValueError, "There must be at least one column");
+      return NULL;
+    }
+    columns.resize(count);
+    memset(columns.data(), 0, count * sizeof(ColumnarColumn));
   }
-
-  PyObject* tuple = PyTuple_New(outList.size());
-  itemIndex = 0;
-  for (std::list<iface::CGRS::GenericValue*>::iterator i = outList.begin();
-       i != outList.end(); i++)
+  else if (!columnarLayout(layout, header, columns))
+    return NULL;
+  header.columnCount = columns.size();
+  header.dataOffset = columnarDataOffset(columns.size());
+  uint64_t size;
+  if (!columnarFileSize(header.dataOffset, header.columnCount, expectedRows, size))
   {
-    // Note: SetItem steals a reference, so we don't need to Py_DECREF...
-    PyTuple_SetItem(tuple, itemIndex++, genericValueToPython(*i));
-    (*i)->release_ref();
+    PyErr_SetString(PyExc_OverflowError, "The expected number of rows is too large");
+    return NULL;
   }
 
-  return tuple;
-}
-
-static PyObject *
-bootstrap_getBootstrap(PyObject *self, PyObject *args)
-{
-  const char* bsname;
-  if (!PyArg_ParseTuple(args, "s", &bsname))
+  Observer* obs = PyObject_New(Observer, &ColumnarSinkType);
+  if (obs == NULL)
     return NULL;
-
-  ObjRef<iface::CGRS::GenericsService> cgs(CreateGenericsService());
-  ObjRef<iface::CGRS::GenericValue> gv;
-
-  try
-  {
-    gv = cgs->getBootstrapByName(bsname);
-  } catch (...) { /* Handled below... */}
-  if (gv == NULL)
+  ColumnarSink* sink = new ColumnarSink();
+  obs->mObserver = sink;
+  std::string why;
+  if (!sink->open(path, header, columns, expectedRows, why))
   {
-    PyErr_Format(PyExc_LookupError, "Bootstrap %s could not be found", bsname);
+    Py_DECREF(obs);
+    PyErr_SetString(PyExc_IOError, why.c_str());
     return NULL;
   }
-
-  return genericValueToPython(gv);
+  return (PyObject*)obs;
 }
 
 static PyObject*
-bootstrap_loadModule(PyObject* self, PyObject* args)
+bootstrap_openColumnarFile(PyObject* self, PyObject* args)
 {
-  PyEval_InitThreads();
-  const char* bspath;
-  if (!PyArg_ParseTuple(args, "s", &bspath))
+  const char* path;
+  if (!PyArg_ParseTuple(args, "s", &path))
     return NULL;
 
-  already_AddRefd<iface::CGRS::GenericsService> cgs(CreateGenericsService());
-  try
+  int fd = open(path, O_RDONLY);
+  if (fd == -1)
+    return PyErr_SetFromErrnoWithFilename(PyExc_IOError, const_cast<char*>(path));
+  struct stat st;
+  void* m = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= sizeof(ColumnarHeader))
+    m = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (m == MAP_FAILED)
   {
-    cgs->loadGenericModule(bspath);
+    PyErr_Format(PyExc_IOError, "%s: Cannot map a columnar file", path);
+    return NULL;
   }
-  catch (...)
+
+  const ColumnarHeader* h = static_cast<const ColumnarHeader*>(m);
+  uint64_t size = st.st_size;
+  if (memcmp(h->magic, kColumnarMagic, sizeof(h->magic)) == 0 && h->status == COLUMNAR_RUNNING)
   {
-    PyErr_Format(PyExc_IOError, "Cannot load module from path %s", bspath);
+    munmap(m, st.st_size);
+    PyErr_Format(PyExc_IOError, "%s: The run writing this file has not finished", path);
+    return NULL;
+  }
+  if (memcmp(h->magic, kColumnarMagic, sizeof(h->magic)) != 0 || h->version != kColumnarVersion ||
+      h->rows > h->rowCapacity || h->dataOffset > size ||
+      h->columnCount > (size - sizeof(ColumnarHeader)) / sizeof(ColumnarColumn) ||
+      (h->columnCount != 0 && h->rowCapacity > (size - h->dataOffset) / sizeof(double) / h->columnCount))
+  {
+    munmap(m, st.st_size);
+    PyErr_Format(PyExc_ValueError, "%s: Not a columnar results file", path);
     return NULL;
   }
 
-  Py_RETURN_NONE;
+  ColumnarFile* file = PyObject_New(ColumnarFile, &ColumnarFileType);
+  if (file == NULL)
+  {
+    munmap(m, st.st_size);
+    return NULL;
+  }
+  file->mMap = static_cast<char*>(m);
+  file->mMapSize = st.st_size;
+  file->mRows = h->rows;
+  file->mRowCapacity = h->rowCapacity;
+  file->mRateCount = h->rateCount;
+  file->mAlgebraicCount = h->algebraicCount;
+  return (PyObject*)file;
 }
 
 static PyMethodDef BootstrapMethods[] = {
@@ -1355,6 +5058,66 @@ static PyMethodDef BootstrapMethods[] = {
      "Get a CGRS bootstrap object."},
     {"loadGenericModule", bootstrap_loadModule, METH_VARARGS,
      "Load a CGRS module."},
+    {"setGILPolicy", bootstrap_setGILPolicy, METH_VARARGS,
+     "setGILPolicy(release[, interface[, member]]): Choose whether the GIL is "
+     "released while native calls run, by default, for an interface, or for "
+     "one member of an interface."},
+    {"setNumericArrays", bootstrap_setNumericArrays, METH_VARARGS,
+     "setNumericArrays(enable): Choose whether sequences of numbers are "
+     "returned as NumericArrays, which support the buffer protocol, instead "
+     "of lists."},
+    {"setStringInterning", bootstrap_setStringInterning, METH_VARARGS,
+     "setStringInterning(maxLength[, capacity]): Share one str object between "
+     "string results of up to maxLength characters, keeping up to capacity "
+     "(by default 4096) of them; 0 turns this off."},
+    {"setIteratorPrefetch", bootstrap_setIteratorPrefetch, METH_VARARGS,
+     "setIteratorPrefetch(batch): Make iterating over native iterators fetch "
+     "up to batch elements at a time ahead of the loop; 0 turns this off."},
+    {"setAsyncCallback", bootstrap_setAsyncCallback, METH_VARARGS,
+     "setAsyncCallback(interface, member[, enable]): Queue calls from native "
+     "code to a void member of Python objects implementing interface, instead "
+     "of waiting for the GIL; they are delivered, oldest first, by "
+     "deliverCallbacks, by the main thread, or before the next synchronous "
+     "callback. Only the main thread delivers them automatically, since "
+     "Python 2.7 runs pending calls only there."},
+    {"deliverCallbacks", bootstrap_deliverCallbacks, METH_NOARGS,
+     "Deliver the queued asynchronous callbacks, merging consecutive calls with "
+     "one list or NumericArray argument, and return how many were queued."},
+    {"createResultRecorder", bootstrap_createResultRecorder, METH_VARARGS,
+     "createResultRecorder(rowLength[, capacity]): Make a progress observer "
+     "that records results natively, without the GIL, as rows of rowLength "
+     "doubles; with a capacity, only the latest capacity rows are kept."},
+    {"createColumnarSink", bootstrap_createColumnarSink, METH_VARARGS,
+     "createColumnarSink(path, layout[, expectedRows]): Make a progress "
+     "observer that streams results, without the GIL, into a memory-mapped "
+     "columnar file. layout is a codeInformation object, whose computation "
+     "targets name the columns, or just the number of columns."},
+    {"openColumnarFile", bootstrap_openColumnarFile, METH_VARARGS,
+     "openColumnarFile(path): Map a file written by a ColumnarSink whose run "
+     "has finished, to read its columns without copying them."},
+    {"allocationStats", bootstrap_allocationStats, METH_NOARGS,
+     "Count the Object, Method and Enum wrappers allocated afresh and reused "
+     "from free-lists."},
+    {"crossingCounts", bootstrap_crossingCounts, METH_NOARGS,
+     "Count the native invocations made from Python (a prefetched batch of "
+     "next() calls counts once) and the calls from native code into Python."},
+    {"setStats", bootstrap_setStats, METH_VARARGS,
+     "setStats(enable): Choose whether statistics for stats() are collected."},
+    {"stats", bootstrap_stats, METH_NOARGS,
+     "Return the statistics collected since resetStats: per interface and "
+     "member, the getattr, setattr, call and callback counts, the number that "
+     "raised, total and histogram of latencies in ns, and the exceptions "
+     "swallowed looking the member up; conversions to Python and to CGRS by "
+     "type; and wrapper allocations."},
+    {"resetStats", bootstrap_resetStats, METH_NOARGS,
+     "Reset the statistics returned by stats()."},
+    {"setTracing", bootstrap_setTracing, METH_VARARGS,
+     "setTracing(enable[, capacity]): Start a new trace of native calls, "
+     "callbacks, and waits for and releases of the GIL, keeping up to "
+     "capacity (by default 65536) events per thread, or stop tracing."},
+    {"dumpTrace", bootstrap_dumpTrace, METH_VARARGS,
+     "dumpTrace(path): Write the events of the latest trace to path as Chrome "
+     "trace-event JSON, and return how many there were."},
     {NULL, NULL, 0, NULL}        /* Sentinel */
 };
 
@@ -1367,7 +5130,13 @@ initbootstrap(void)
   if (m == NULL)
     return;
 
+  sCGS = CreateGenericsService();
+
   PyType_Ready(&ObjectType);
   PyType_Ready(&EnumType);
   PyType_Ready(&MethodType);
+  PyType_Ready(&NumericArrayType);
+  PyType_Ready(&RecorderType);
+  PyType_Ready(&ColumnarSinkType);
+  PyType_Ready(&ColumnarFileType);
 }
@@ -3,6 +3,8 @@ import sys
 import cgrspy.bootstrap
 import unittest
 import threading
+import tempfile
+import os
 
 class CISMock:
     def __init__(self, codeInfo, lock):
@@ -34,6 +36,7 @@ class CISMock:
             self.ctSize = 2 * self.codeInfo.rateIndexCount + 1 + self.codeInfo.algebraicIndexCount
 
     def results(self, state):
+        self.lastState = state
         for i in range(0, len(state), self.ctSize):
             if abs(state[self.ctMap['time'] + i] - 10.0) < 1E-3:
                 self.success = abs(state[self.ctMap['x'] + i] - 22026.497973264843) < 1E-3
@@ -56,6 +59,47 @@ class TestCGRSPy(unittest.TestCase):
     def test_createModelInvalidVersion(self):
         self.assertRaises(ValueError, self.cellmlBootstrap.createModel, "0.9")
 
+    def test_internedEnum(self):
+        mod = self.cellmlBootstrap.createModel("1.1")
+        var = mod.createCellMLVariable()
+        iface = var.publicInterface
+        self.assertTrue(iface is var.publicInterface)
+        var.publicInterface = iface
+        self.assertRaises((TypeError, AttributeError), setattr, iface, "asInteger", 0)
+
+    def test_wideStrings(self):
+        mod = self.cellmlBootstrap.createModel("1.1")
+        comp = mod.createComponent()
+        comp.name = u"ascii"
+        self.assertTrue(type(comp.name) is str)
+        name = u"r\xe9action_\u4e2d\U0001d49c"
+        comp.name = name
+        self.assertEqual(name, comp.name)
+        comp.name = "x" * 1000000
+        self.assertEqual(1000000, len(comp.name))
+
+    def test_stringInterning(self):
+        mod = self.cellmlBootstrap.createModel("1.1")
+        variables = []
+        for n in ["x", "y"]:
+            v = mod.createCellMLVariable()
+            v.unitsName = "dimensionless"
+            variables.append(v)
+        cgrspy.bootstrap.setStringInterning(32)
+        try:
+            self.assertTrue(variables[0].unitsName is variables[1].unitsName)
+            self.assertTrue(variables[0].unitsName is "dimensionless")
+        finally:
+            cgrspy.bootstrap.setStringInterning(0)
+        self.assertEqual("dimensionless", variables[0].unitsName)
+        self.assertRaises(ValueError, cgrspy.bootstrap.setStringInterning, -1)
+
+    def test_argumentCount(self):
+        createModel = self.cellmlBootstrap.createModel
+        self.assertRaises(ValueError, createModel)
+        self.assertRaises(ValueError, createModel, "1.1", "1.1")
+        self.assertTrue(createModel("1.1") != 0)
+
     def test_iterate(self):
         mod = self.cellmlBootstrap.createModel("1.1")
         namelist = ["mycomponent", "yourcomponent", "ourcomponent"]
@@ -75,7 +119,58 @@ class TestCGRSPy(unittest.TestCase):
             i = i + 1
         self.assertEqual(i, len(namelist))
 
-    def test_callback(self):
+    def test_identity(self):
+        mod = self.cellmlBootstrap.createModel("1.1")
+        comp = mod.createComponent()
+        comp.name = "mycomponent"
+        mod.addElement(comp)
+        found = [c for c in mod.allComponents]
+        self.assertTrue(found[0] is comp)
+        self.assertEqual(comp, found[0])
+        self.assertEqual({comp: 1}[found[0]], 1)
+        self.assertNotEqual(comp, mod)
+
+    def test_iteratePrefetch(self):
+        mod = self.cellmlBootstrap.createModel("1.1")
+        namelist = ["c%d" % i for i in range(10)]
+        for n in namelist:
+            comp = mod.createComponent()
+            comp.name = n
+            mod.addElement(comp)
+        try:
+            for batch in [1, 3, 10, 64]:
+                cgrspy.bootstrap.setIteratorPrefetch(batch)
+                self.assertEqual(namelist, [c.name for c in mod.allComponents])
+        finally:
+            cgrspy.bootstrap.setIteratorPrefetch(0)
+        self.assertRaises(ValueError, cgrspy.bootstrap.setIteratorPrefetch, -1)
+
+    def test_memberLookupCache(self):
+        mod = self.cellmlBootstrap.createModel("1.1")
+        for n in ["mycomponent", "yourcomponent"]:
+            comp = mod.createComponent()
+            comp.name = n
+            self.assertEqual(n, comp.name)
+        # Misses are cached too, and must keep raising.
+        for i in range(2):
+            self.assertRaises(ValueError, getattr, mod, "noSuchMember")
+            self.assertRaises(ValueError, setattr, mod, "noSuchMember", 1)
+
+    def test_gilPolicy(self):
+        mod = self.cellmlBootstrap.createModel("1.1")
+        comp = mod.createComponent()
+        try:
+            cgrspy.bootstrap.setGILPolicy(False, "cellml_api::NamedCellMLElement", "name")
+            comp.name = "held"
+            self.assertEqual("held", comp.name)
+            cgrspy.bootstrap.setGILPolicy(False)
+            mod.addElement(comp)
+        finally:
+            cgrspy.bootstrap.setGILPolicy(True)
+            cgrspy.bootstrap.setGILPolicy(True, "cellml_api::NamedCellMLElement", "name")
+        self.assertRaises(ValueError, cgrspy.bootstrap.setGILPolicy, True, None, "name")
+
+    def createIntegrationRun(self):
         cgrspy.bootstrap.loadGenericModule('cgrs_xpcom')
         cgrspy.bootstrap.loadGenericModule('cgrs_cis')
         cgrspy.bootstrap.loadGenericModule('cgrs_ccgs')
@@ -111,14 +206,77 @@ class TestCGRSPy(unittest.TestCase):
         stepType.asString = "ADAMS_MOULTON_1_12"
         solrun.stepType = stepType
         solrun.setResultRange(0, 10, 0.1)
+        return compmod, solrun
+
+    def runIntegration(self):
+        compmod, solrun = self.createIntegrationRun()
         lock = threading.Lock()
         lock.acquire()
         mock = CISMock(compmod.codeInformation, lock)
         solrun.setProgressObserver(mock)
         solrun.start()
         lock.acquire()
+        return mock
+
+    def test_callback(self):
+        mock = self.runIntegration()
         self.assertEqual(True, mock.success)
 
+    def test_numericArrays(self):
+        cgrspy.bootstrap.setNumericArrays(True)
+        try:
+            mock = self.runIntegration()
+        finally:
+            cgrspy.bootstrap.setNumericArrays(False)
+        self.assertEqual(True, mock.success)
+        self.assertEqual('d', mock.lastState.typecode)
+
+    def test_asyncCallback(self):
+        observer = "cellml_services::IntegrationProgressObserver"
+        cgrspy.bootstrap.loadGenericModule('cgrs_cis')
+        self.assertRaises(ValueError, cgrspy.bootstrap.setAsyncCallback, observer, "noSuchMember")
+        cgrspy.bootstrap.setAsyncCallback(observer, "results")
+        try:
+            mock = self.runIntegration()
+        finally:
+            cgrspy.bootstrap.setAsyncCallback(observer, "results", False)
+        self.assertEqual(0, cgrspy.bootstrap.deliverCallbacks())
+        self.assertEqual(True, mock.success)
+
+    def test_resultRecorder(self):
+        compmod, solrun = self.createIntegrationRun()
+        mock = CISMock(compmod.codeInformation, None)
+        recorder = cgrspy.bootstrap.createResultRecorder(mock.ctSize)
+        solrun.setProgressObserver(recorder)
+        solrun.start()
+        self.assertTrue(recorder.wait())
+        self.assertEqual(None, recorder.error)
+        last = len(recorder) - 1
+        self.assertTrue(abs(recorder.column(mock.ctMap['time'])[last] - 10.0) < 1E-3)
+        self.assertTrue(abs(recorder[last][mock.ctMap['x']] - 22026.497973264843) < 1E-3)
+        self.assertEqual((len(recorder), mock.ctSize), memoryview(recorder).shape)
+
+    def test_columnarSink(self):
+        compmod, solrun = self.createIntegrationRun()
+        fd, path = tempfile.mkstemp()
+        os.close(fd)
+        try:
+            sink = cgrspy.bootstrap.createColumnarSink(path, compmod.codeInformation)
+            solrun.setProgressObserver(sink)
+            solrun.start()
+            self.assertTrue(sink.wait())
+            self.assertEqual(None, sink.error)
+            results = cgrspy.bootstrap.openColumnarFile(path)
+            self.assertEqual("DONE", results.status)
+            self.assertEqual(len(sink), len(results))
+            self.assertEqual("VARIABLE_OF_INTEGRATION", results.kinds[0])
+            x = results.column(results.names.index('x'))
+            self.assertTrue(abs(results.column('time')[len(results) - 1] - 10.0) < 1E-3)
+            self.assertTrue(abs(x[len(results) - 1] - 22026.497973264843) < 1E-3)
+            del results, x
+        finally:
+            os.remove(path)
+
 def runTests():
     suite = unittest.TestLoader().loadTestsFromTestCase(TestCGRSPy)
     unittest.TextTestRunner(verbosity=2).run(suite)
@@ -0,0 +1,304 @@
+# Tests of the binding against the stand-in CGRS in mock/, which needs no
+# CellML API build: python setup.py --mock build test
+import array
+import json
+import os
+import tempfile
+import threading
+import cgrspy.bootstrap
+import unittest
+
+class Observer:
+    def __init__(self):
+        self.values = []
+        self.finished = threading.Event()
+
+    def results(self, state):
+        self.values.extend(state)
+
+    def done(self):
+        self.finished.set()
+
+    def failed(self, why):
+        self.finished.set()
+
+class TestMockCGRS(unittest.TestCase):
+    def setUp(self):
+        cgrspy.bootstrap.loadGenericModule('cgrs_mock')
+        self.service = cgrspy.bootstrap.fetch('CreateMockService')
+
+    def things(self, count):
+        it = self.service.createThingSet(count).iterate()
+        things = []
+        while True:
+            t = it.next()
+            if t == None:
+                return things
+            things.append(t)
+
+    def test_attributes(self):
+        t = self.service.createThing()
+        t.name = "thing"
+        self.assertEqual("thing", t.name)
+        t.value = 2.5
+        self.assertEqual(5.0, t.scaled(2.0))
+        self.assertEqual("ALPHA", t.kind.asString)
+        t.kind = self.service.echoKind(t.kind)
+        self.assertRaises(ValueError, getattr, t, "noSuchMember")
+        self.assertRaises(ValueError, t.fail)
+        self.assertEqual((0, "thing"), t.split())
+
+    def test_enums(self):
+        t = self.service.createThing()
+        kind = t.kind
+        self.assertTrue(kind is t.kind)
+        self.assertRaises(TypeError, setattr, kind, "asInteger", 3)
+        self.assertRaises(TypeError, kind.__init__, "X", 3)
+        self.assertEqual(("ALPHA", 0), (kind.asString, kind.asInteger))
+        mine = type(kind)("BETA", 1)
+        mine.asInteger = 2
+        mine.__init__("GAMMA", 3)
+        self.assertEqual(("GAMMA", 3), (mine.asString, mine.asInteger))
+
+    def test_wideStrings(self):
+        t = self.service.createThing()
+        for name in [u"ascii", u"r\xe9action_\u4e2d\U0001d49c", u"x" * 1000000]:
+            t.wname = name
+            self.assertEqual(name, t.wname)
+        self.assertTrue(type(t.wname) is str)
+
+    def test_identity(self):
+        t = self.service.createThing()
+        self.assertTrue(t.self is t)
+        self.assertTrue(self.service.echoObject(t) is t)
+        self.assertEqual(None, self.service.echoObject(None))
+
+    def test_iteratePrefetch(self):
+        names = ["thing%d" % i for i in range(10)]
+        try:
+            for batch in [0, 1, 3, 64]:
+                cgrspy.bootstrap.setIteratorPrefetch(batch)
+                self.assertEqual(names, [t.name for t in self.service.createThingSet(10)])
+
+                # Alternate the iterator protocol with explicit next() calls.
+                it = self.service.createThingSet(10).iterate()
+                mixed = []
+                while True:
+                    if len(mixed) % 2 == 0:
+                        t = next(it, None)
+                    else:
+                        t = it.next()
+                    if t == None:
+                        break
+                    mixed.append(t.name)
+                self.assertEqual(names, mixed)
+
+                # The things before a native failure are still returned.
+                failing = self.service.createThingSet(10)
+                failing.failAt = 5
+                seen = []
+                def consume():
+                    for t in failing:
+                        seen.append(t.name)
+                self.assertRaises(ValueError, consume)
+                self.assertEqual(names[:5], seen)
+        finally:
+            cgrspy.bootstrap.setIteratorPrefetch(0)
+
+    def test_memberLookupCache(self):
+        t = self.service.createThing()
+        t.name
+        before = self.service.reflectionCallCount
+        for i in range(10):
+            t.name
+        self.assertEqual(before, self.service.reflectionCallCount)
+
+    def test_crossingCounts(self):
+        t = self.service.createThing()
+        before = cgrspy.bootstrap.crossingCounts()
+        t.name = t.name
+        t.scaled(2.0)
+        self.service.callObserver(Observer(), 3, 1)
+        after = cgrspy.bootstrap.crossingCounts()
+        self.assertEqual(4, after["native"] - before["native"])
+        self.assertEqual(4, after["python"] - before["python"])
+
+    def test_stats(self):
+        t = self.service.createThing()
+        cgrspy.bootstrap.resetStats()
+        t.name = "thing"
+        self.assertEqual({}, cgrspy.bootstrap.stats()["members"])
+        cgrspy.bootstrap.setStats(True)
+        try:
+            t.name = t.name
+            t.scaled(2.0)
+            self.assertRaises(ValueError, t.fail)
+            self.service.callObserver(Observer(), 3, 1)
+            self.assertRaises(ValueError, getattr, t, "noSuchMember")
+        finally:
+            cgrspy.bootstrap.setStats(False)
+        stats = cgrspy.bootstrap.stats()
+        self.assertFalse(stats["enabled"])
+        thing = stats["members"]["Mock::Thing"]
+        self.assertEqual(1, thing["name"]["getattr"]["count"])
+        self.assertEqual(1, thing["name"]["setattr"]["count"])
+        self.assertEqual(1, thing["fail"]["call"]["raised"])
+        self.assertTrue(thing["noSuchMember"]["swallowed"] > 0)
+        scaled = thing["scaled"]["call"]
+        self.assertEqual(1, sum([n for bound, n in scaled["histogram"]]))
+        self.assertTrue(scaled["histogram"][0][0] > 0)
+        observer = stats["members"]["cellml_services::IntegrationProgressObserver"]
+        self.assertEqual(3, observer["results"]["callback"]["count"])
+        self.assertTrue(stats["conversions"]["toNative"]["double"] >= 1)
+        self.assertTrue(stats["conversions"]["toPython"]["string"] >= 1)
+        cgrspy.bootstrap.resetStats()
+        self.assertEqual({}, cgrspy.bootstrap.stats()["members"])
+
+    def test_trace(self):
+        t = self.service.createThing()
+        cgrspy.bootstrap.setTracing(True)
+        try:
+            t.name = "thing"
+            t.scaled(2.0)
+            run = self.service.createIntegrationRun(10, 10, 1)
+            observer = Observer()
+            run.setProgressObserver(observer)
+            run.start()
+            observer.finished.wait()
+        finally:
+            cgrspy.bootstrap.setTracing(False)
+        t.scaled(2.0)
+        fd, path = tempfile.mkstemp()
+        os.close(fd)
+        try:
+            count = cgrspy.bootstrap.dumpTrace(path)
+            f = open(path)
+            trace = json.load(f)
+            f.close()
+        finally:
+            os.remove(path)
+        events = trace["traceEvents"]
+        self.assertEqual(count, len(events))
+        self.assertEqual(0, trace["otherData"]["dropped"])
+        scaled = [e["ph"] for e in events if e["name"] == "Mock::Thing::scaled"]
+        self.assertEqual(["B", "E"], scaled)
+        self.assertTrue("setattr" in [e["cat"] for e in events])
+        callbacks = [e for e in events if e["cat"] == "callback"]
+        self.assertTrue(len(callbacks) >= 2)
+        self.assertTrue(len(set([e["tid"] for e in events])) >= 2)
+        gil = [e["ph"] for e in events if e["cat"] == "gil"]
+        self.assertTrue("i" in gil and "B" in gil)
+        self.assertRaises(IOError, cgrspy.bootstrap.dumpTrace, "/no/such/dir/trace.json")
+
+    def test_numericArrays(self):
+        self.assertEqual([0.0, 0.5, 1.0], self.service.makeDoubles(3))
+        cgrspy.bootstrap.setNumericArrays(True)
+        try:
+            values = self.service.makeDoubles(1000)
+        finally:
+            cgrspy.bootstrap.setNumericArrays(False)
+        self.assertEqual('d', values.typecode)
+        self.assertEqual(249750.0, self.service.sumDoubles(values))
+        self.assertEqual(6, self.service.sumLongs(array.array('i', [1, 2, 3])))
+
+    def test_callback(self):
+        observer = Observer()
+        self.service.callObserver(observer, 10, 5)
+        self.assertEqual(50, len(observer.values))
+        self.assertTrue(observer.finished.is_set())
+
+    def test_callbackReplaced(self):
+        observer = Observer()
+        later = []
+        def first(state):
+            observer.results = later.append
+        observer.results = first
+        self.service.callObserver(observer, 3, 1)
+        self.assertEqual(2, len(later))
+
+    def test_asyncCallback(self):
+        iface = "cellml_services::IntegrationProgressObserver"
+        cgrspy.bootstrap.setAsyncCallback(iface, "results")
+        try:
+            observer = Observer()
+            run = self.service.createIntegrationRun(100, 10, 3)
+            run.setProgressObserver(observer)
+            run.start()
+            while not observer.finished.wait(0.01):
+                pass
+        finally:
+            cgrspy.bootstrap.setAsyncCallback(iface, "results", False)
+        self.assertEqual(3000, len(observer.values))
+
+    def test_resultRecorder(self):
+        recorder = cgrspy.bootstrap.createResultRecorder(3)
+        run = self.service.createIntegrationRun(100, 10, 3)
+        run.setProgressObserver(recorder)
+        run.start()
+        self.assertTrue(recorder.wait())
+        self.assertEqual(1000, len(recorder))
+        self.assertEqual(999.002, recorder.column(2)[999])
+        self.assertEqual((1000, 3), memoryview(recorder).shape)
+
+        ring = cgrspy.bootstrap.createResultRecorder(3, 15)
+        run = self.service.createIntegrationRun(100, 10, 3)
+        run.setProgressObserver(ring)
+        run.start()
+        self.assertTrue(ring.wait())
+        view = memoryview(ring)
+        self.assertEqual((15, 3), view.shape)
+        self.assertEqual(list(recorder.column(0)[985:]), list(ring.column(0)))
+        self.assertEqual(view.tobytes(), memoryview(ring).tobytes())
+
+        self.assertEqual((0, 3), memoryview(cgrspy.bootstrap.createResultRecorder(3)).shape)
+        self.assertRaises(MemoryError, cgrspy.bootstrap.createResultRecorder, 1, 2 ** 61)
+        self.assertRaises(MemoryError, cgrspy.bootstrap.createResultRecorder, 1, 2 ** 59)
+
+        partial = cgrspy.bootstrap.createResultRecorder(4)
+        self.service.callObserver(partial, 2, 3)
+        self.assertTrue(partial.wait())
+        self.assertEqual(0, len(partial))
+        self.assertTrue(partial.error)
+
+    def test_columnarSink(self):
+        fd, path = tempfile.mkstemp()
+        os.close(fd)
+        try:
+            self.assertRaises(OverflowError, cgrspy.bootstrap.createColumnarSink, path, 2, 2 ** 62)
+            sink = cgrspy.bootstrap.createColumnarSink(path, 3)
+            self.assertRaises(IOError, cgrspy.bootstrap.openColumnarFile, path)
+            run = self.service.createIntegrationRun(100, 10, 3)
+            run.setProgressObserver(sink)
+            run.start()
+            self.assertTrue(sink.wait())
+            results = cgrspy.bootstrap.openColumnarFile(path)
+            self.assertEqual(1000, len(results))
+            self.assertEqual(999.001, results.column(1)[999])
+            del results
+
+            partial = cgrspy.bootstrap.createColumnarSink(path, 4)
+            self.service.callObserver(partial, 2, 3)
+            self.assertTrue(partial.error)
+            self.assertEqual("FAILED", cgrspy.bootstrap.openColumnarFile(path).status)
+        finally:
+            os.remove(path)
+
+    def test_stringInterning(self):
+        things = self.things(2)
+        for t in things:
+            t.wname = u"dimensionless"
+        cgrspy.bootstrap.setStringInterning(32)
+        try:
+            self.assertTrue(things[0].wname is things[1].wname)
+        finally:
+            cgrspy.bootstrap.setStringInterning(0)
+        self.assertFalse(things[0].wname is things[1].wname)
+
+def runTests():
+    suite = unittest.TestLoader().loadTestsFromTestCase(TestMockCGRS)
+    unittest.TextTestRunner(verbosity=2).run(suite)
+
+def test_suite():
+    suite = unittest.TestSuite()
+    suite.addTest(unittest.makeSuite(TestMockCGRS))
+    return suite
@@ -0,0 +1,1424 @@
+// A self-contained stand-in for the CellML Generics and Reflection Service.
+//
+// It implements the reflection interfaces, value types and GenericsService
+// that cgrspy talks to, plus a small set of synthetic objects whose member
+// counts, sequence sizes and string lengths are configurable at runtime. This
+// lets the binding be built, tested and benchmarked without a CellML API
+// build.
+
+#include "IfaceCGRS.hxx"
+#include "CGRSBootstrap.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+
+namespace mock
+{
+  // Counters exported through Mock::Service so that tests and benchmarks can
+  // observe how much reflection work the binding does.
+  static std::atomic<long long> gReflectionCalls(0);
+  static std::atomic<long long> gServiceFetches(0);
+  static std::atomic<long long> gInvocations(0);
+  static std::atomic<long long> gReflectionMisses(0);
+  static std::atomic<long long> gAllocations(0);
+
+  // Tunables for the synthetic objects.
+  static std::atomic<int32_t> gStringLength(8);
+  static std::atomic<int32_t> gSequenceLength(16);
+
+  static std::string
+  objidFor(const void* aPtr)
+  {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "mock:%p", aPtr);
+    return buf;
+  }
+
+  // Every mock object holds one of these, so constructing it counts as one
+  // native allocation.
+  struct MockRefcount
+    : public std::atomic<int>
+  {
+    MockRefcount(int aValue) : std::atomic<int>(aValue) { gAllocations++; }
+  };
+
+#define MOCK_REFCOUNT \
+  public: \
+    void add_ref() throw() { mRefcount.fetch_add(1); } \
+    void release_ref() throw() \
+    { \
+      if (mRefcount.fetch_sub(1) == 1) \
+        delete this; \
+    } \
+    std::string objid() throw() { return objidFor(this); } \
+  private: \
+    MockRefcount mRefcount; \
+  public:
+
+#define MOCK_QI_BEGIN \
+  void* query_interface(const std::string& aIface) throw() \
+  { \
+    if (aIface == "XPCOM::IObject") \
+    { \
+      add_ref(); \
+      return reinterpret_cast<void*>(static_cast<iface::XPCOM::IObject*>(this)); \
+    }
+#define MOCK_QI(name) \
+    if (aIface == #name) \
+    { \
+      add_ref(); \
+      return reinterpret_cast<void*>(static_cast<iface::name*>(this)); \
+    }
+#define MOCK_QI_END \
+    return NULL; \
+  }
+
+  class MockType
+    : public virtual iface::CGRS::GenericType
+  {
+    MOCK_REFCOUNT
+
+    MockType(const std::string& aName)
+      : mRefcount(1), mName(aName)
+    {
+    }
+
+    MOCK_QI_BEGIN
+    MOCK_QI(CGRS::GenericType)
+    MOCK_QI_END
+
+    std::vector<std::string> supported_interfaces() throw()
+    {
+      std::vector<std::string> v;
+      v.push_back("XPCOM::IObject");
+      v.push_back("CGRS::GenericType");
+      return v;
+    }
+
+    std::string asString() { return mName; }
+
+  private:
+    std::string mName;
+  };
+
+  class MockSequenceType
+    : public virtual iface::CGRS::SequenceType
+  {
+    MOCK_REFCOUNT
+
+    MockSequenceType(iface::CGRS::GenericType* aInner)
+      : mRefcount(1), mInner(aInner)
+    {
+    }
+
+    MOCK_QI_BEGIN
+    MOCK_QI(CGRS::GenericType)
+    MOCK_QI(CGRS::SequenceType)
+    MOCK_QI_END
+
+    std::vector<std::string> supported_interfaces() throw()
+    {
+      std::vector<std::string> v;
+      v.push_back("XPCOM::IObject");
+      v.push_back("CGRS::GenericType");
+      v.push_back("CGRS::SequenceType");
+      return v;
+    }
+
+    std::string asString() { return "sequence<" + mInner->asString() + ">"; }
+
+    already_AddRefd<iface::CGRS::GenericType> innerType()
+    {
+      mInner->add_ref();
+      return mInner.getPointer();
+    }
+
+  private:
+    ObjRef<iface::CGRS::GenericType> mInner;
+  };
+
+  class MockEnumType
+    : public virtual iface::CGRS::EnumType
+  {
+    MOCK_REFCOUNT
+
+    MockEnumType(const std::string& aName, const std::vector<std::string>& aValues)
+      : mRefcount(1), mName(aName), mValues(aValues)
+    {
+    }
+
+    MOCK_QI_BEGIN
+    MOCK_QI(CGRS::GenericType)
+    MOCK_QI(CGRS::EnumType)
+    MOCK_QI_END
+
+    std::vector<std::string> supported_interfaces() throw()
+    {
+      std::vector<std::string> v;
+      v.push_back("XPCOM::IObject");
+      v.push_back("CGRS::GenericType");
+      v.push_back("CGRS::EnumType");
+      return v;
+    }
+
+    std::string asString() { return mName; }
+    int32_t maxIndex() { return static_cast<int32_t>(mValues.size()) - 1; }
+
+    std::string indexToName(int32_t aIndex)
+    {
+      if (aIndex < 0 || aIndex > maxIndex())
+        throw iface::CellML_APISPEC::CellMLException();
+      return mValues[aIndex];
+    }
+
+    int32_t nameToIndex(const std::string& aName)
+    {
+      for (size_t i = 0; i < mValues.size(); i++)
+        if (mValues[i] == aName)
+          return static_cast<int32_t>(i);
+      throw iface::CellML_APISPEC::CellMLException();
+    }
+
+  private:
+    std::string mName;
+    std::vector<std::string> mValues;
+  };
+
+  static already_AddRefd<iface::CGRS::GenericType> builtinType(const std::string& aName);
+
+  // Scalar values. Each CGRS scalar interface names its getter differently, so
+  // the classes are stamped out with a macro.
+#define MOCK_SCALAR(cls, ifacename, ctype, getter, tname) \
+  class cls \
+    : public virtual iface::CGRS::ifacename \
+  { \
+    MOCK_REFCOUNT \
+    cls(ctype aValue) : mRefcount(1), mValue(aValue) {} \
+    MOCK_QI_BEGIN \
+    MOCK_QI(CGRS::GenericValue) \
+    MOCK_QI(CGRS::ifacename) \
+    MOCK_QI_END \
+    std::vector<std::string> supported_interfaces() throw() \
+    { \
+      std::vector<std::string> v; \
+      v.push_back("XPCOM::IObject"); \
+      v.push_back("CGRS::GenericValue"); \
+      v.push_back("CGRS::" #ifacename); \
+      return v; \
+    } \
+    already_AddRefd<iface::CGRS::GenericType> typeOfValue() { return builtinType(tname); } \
+    ctype getter() { return mValue; } \
+  private: \
+    ctype mValue; \
+  };
+
+  MOCK_SCALAR(MockStringValue, StringValue, std::string, asString, "string")
+  MOCK_SCALAR(MockWStringValue, WStringValue, std::wstring, asWString, "wstring")
+  MOCK_SCALAR(MockShortValue, ShortValue, int16_t, asShort, "short")
+  MOCK_SCALAR(MockLongValue, LongValue, int32_t, asLong, "long")
+  MOCK_SCALAR(MockLongLongValue, LongLongValue, int64_t, asLongLong, "long long")
+  MOCK_SCALAR(MockUShortValue, UShortValue, uint16_t, asUShort, "unsigned short")
+  MOCK_SCALAR(MockULongValue, ULongValue, uint32_t, asULong, "unsigned long")
+  MOCK_SCALAR(MockULongLongValue, ULongLongValue, uint64_t, asULongLong, "unsigned long long")
+  MOCK_SCALAR(MockFloatValue, FloatValue, float, asFloat, "float")
+  MOCK_SCALAR(MockDoubleValue, DoubleValue, double, asDouble, "double")
+  MOCK_SCALAR(MockBooleanValue, BooleanValue, bool, asBoolean, "boolean")
+  MOCK_SCALAR(MockCharValue, CharValue, char, asChar, "char")
+  MOCK_SCALAR(MockOctetValue, OctetValue, uint8_t, asOctet, "octet")
+
+#undef MOCK_SCALAR
+
+  class MockVoidValue
+    : public virtual iface::CGRS::VoidValue
+  {
+    MOCK_REFCOUNT
+
+    MockVoidValue() : mRefcount(1) {}
+
+    MOCK_QI_BEGIN
+    MOCK_QI(CGRS::GenericValue)
+    MOCK_QI(CGRS::VoidValue)
+    MOCK_QI_END
+
+    std::vector<std::string> supported_interfaces() throw()
+    {
+      std::vector<std::string> v;
+      v.push_back("XPCOM::IObject");
+      v.push_back("CGRS::GenericValue");
+      v.push_back("CGRS::VoidValue");
+      return v;
+    }
+
+    already_AddRefd<iface::CGRS::GenericType> typeOfValue() { return builtinType("void"); }
+  };
+
+  class MockEnumValue
+    : public virtual iface::CGRS::EnumValue
+  {
+    MOCK_REFCOUNT
+
+    MockEnumValue(iface::CGRS::EnumType* aType, int32_t aIndex)
+      : mRefcount(1), mType(aType), mIndex(aIndex)
+    {
+    }
+
+    MOCK_QI_BEGIN
+    MOCK_QI(CGRS::GenericValue)
+    MOCK_QI(CGRS::EnumValue)
+    MOCK_QI_END
+
+    std::vector<std::string> supported_interfaces() throw()
+    {
+      std::vector<std::string> v;
+      v.push_back("XPCOM::IObject");
+      v.push_back("CGRS::GenericValue");
+      v.push_back("CGRS::EnumValue");
+      return v;
+    }
+
+    already_AddRefd<iface::CGRS::GenericType> typeOfValue()
+    {
+      mType->add_ref();
+      return static_cast<iface::CGRS::GenericType*>(mType.getPointer());
+    }
+
+    int32_t asLong() { return mIndex; }
+    std::string asString() { return mType->indexToName(mIndex); }
+
+  private:
+    ObjRef<iface::CGRS::EnumType> mType;
+    int32_t mIndex;
+  };
+
+  class MockObjectValue
+    : public virtual iface::CGRS::ObjectValue
+  {
+    MOCK_REFCOUNT
+
+    MockObjectValue(iface::XPCOM::IObject* aObject)
+      : mRefcount(1), mObject(aObject)
+    {
+    }
+
+    MOCK_QI_BEGIN
+    MOCK_QI(CGRS::GenericValue)
+    MOCK_QI(CGRS::ObjectValue)
+    MOCK_QI_END
+
+    std::vector<std::string> supported_interfaces() throw()
+    {
+      std::vector<std::string> v;
+      v.push_back("XPCOM::IObject");
+      v.push_back("CGRS::GenericValue");
+      v.push_back("CGRS::ObjectValue");
+      return v;
+    }
+
+    already_AddRefd<iface::CGRS::GenericType> typeOfValue() { return builtinType("XPCOM::IObject"); }
+
+    already_AddRefd<iface::XPCOM::IObject> asObject()
+    {
+      if (mObject != NULL)
+        mObject->add_ref();
+      return mObject.getPointer();
+    }
+
+  private:
+    ObjRef<iface::XPCOM::IObject> mObject;
+  };
+
+  class MockSequenceValue
+    : public virtual iface::CGRS::SequenceValue
+  {
+    MOCK_REFCOUNT
+
+    MockSequenceValue(iface::CGRS::GenericType* aInner)
+      : mRefcount(1), mInner(aInner)
+    {
+    }
+
+    ~MockSequenceValue()
+    {
+      for (std::vector<iface::CGRS::GenericValue*>::iterator i = mValues.begin();
+           i != mValues.end(); i++)
+        (*i)->release_ref();
+    }
+
+    MOCK_QI_BEGIN
+    MOCK_QI(CGRS::GenericValue)
+    MOCK_QI(CGRS::SequenceValue)
+    MOCK_QI_END
+
+    std::vector<std::string> supported_interfaces() throw()
+    {
+      std::vector<std::string> v;
+      v.push_back("XPCOM::IObject");
+      v.push_back("CGRS::GenericValue");
+      v.push_back("CGRS::SequenceValue");
+      return v;
+    }
+
+    already_AddRefd<iface::CGRS::GenericType> typeOfValue()
+    {
+      return static_cast<iface::CGRS::GenericType*>(new MockSequenceType(mInner));
+    }
+
+    int32_t valueCount() { return static_cast<int32_t>(mValues.size()); }
+
+    already_AddRefd<iface::CGRS::GenericValue> getValueByIndex(int32_t aIndex)
+    {
+      if (aIndex < 0 || aIndex >= valueCount())
+        throw iface::CellML_APISPEC::CellMLException();
+      mValues[aIndex]->add_ref();
+      return mValues[aIndex];
+    }
+
+    void appendValue(iface::CGRS::GenericValue* aValue)
+    {
+      aValue->add_ref();
+      mValues.push_back(aValue);
+    }
+
+  private:
+    ObjRef<iface::CGRS::GenericType> mInner;
+    std::vector<iface::CGRS::GenericValue*> mValues;
+  };
+
+  // Reflection.
+  class MockObject;
+  typedef std::function<iface::CGRS::GenericValue*(MockObject*, const std::vector<iface::CGRS::GenericValue*>&,
+                                                   std::vector<iface::CGRS::GenericValue*>&)> MockInvoker;
+
+  class MockParameter
+    : public virtual iface::CGRS::GenericParameter
+  {
+    MOCK_REFCOUNT
+
+    MockParameter(const std::string& aName, iface::CGRS::GenericType* aType, bool aIn, bool aOut)
+      : mRefcount(1), mName(aName), mType(aType), mIn(aIn), mOut(aOut)
+    {
+    }
+
+    MOCK_QI_BEGIN
+    MOCK_QI(CGRS::GenericParameter)
+    MOCK_QI_END
+
+    std::vector<std::string> supported_interfaces() throw()
+    {
+      std::vector<std::string> v;
+      v.push_back("XPCOM::IObject");
+      v.push_back("CGRS::GenericParameter");
+      return v;
+    }
+
+    bool isIn() { return mIn; }
+    bool isOut() { return mOut; }
+    std::string name() { return mName; }
+    already_AddRefd<iface::CGRS::GenericType> type()
+    {
+      mType->add_ref();
+      return mType.getPointer();
+    }
+
+  private:
+    std::string mName;
+    ObjRef<iface::CGRS::GenericType> mType;
+    bool mIn, mOut;
+  };
+
+  class MockMethod
+    : public virtual iface::CGRS::GenericMethod
+  {
+    MOCK_REFCOUNT
+
+    MockMethod(const std::string& aName, iface::CGRS::GenericType* aReturnType,
+               const MockInvoker& aInvoker)
+      : mRefcount(1), mName(aName), mReturnType(aReturnType), mInvoker(aInvoker)
+    {
+    }
+
+    ~MockMethod()
+    {
+      for (std::vector<iface::CGRS::GenericParameter*>::iterator i = mParameters.begin();
+           i != mParameters.end(); i++)
+        (*i)->release_ref();
+    }
+
+    MockMethod* param(const std::string& aName, const std::string& aType, bool aIn = true, bool aOut = false);
+    MockMethod* param(const std::string& aName, iface::CGRS::GenericType* aType, bool aIn = true, bool aOut = false)
+    {
+      mParameters.push_back(new MockParameter(aName, aType, aIn, aOut));
+      return this;
+    }
+
+    MOCK_QI_BEGIN
+    MOCK_QI(CGRS::GenericMethod)
+    MOCK_QI_END
+
+    std::vector<std::string> supported_interfaces() throw()
+    {
+      std::vector<std::string> v;
+      v.push_back("XPCOM::IObject");
+      v.push_back("CGRS::GenericMethod");
+      return v;
+    }
+
+    std::string name() { return mName; }
+
+    std::vector<iface::CGRS::GenericParameter*> parameters()
+    {
+      gReflectionCalls++;
+      for (std::vector<iface::CGRS::GenericParameter*>::iterator i = mParameters.begin();
+           i != mParameters.end(); i++)
+        (*i)->add_ref();
+      return mParameters;
+    }
+
+    already_AddRefd<iface::CGRS::GenericType> returnType()
+    {
+      mReturnType->add_ref();
+      return mReturnType.getPointer();
+    }
+
+    already_AddRefd<iface::CGRS::GenericValue>
+    invoke(iface::CGRS::GenericValue* aInvokeOn,
+           const std::vector<iface::CGRS::GenericValue*>& aInValues,
+           std::vector<iface::CGRS::GenericValue*>& aOutValues,
+           bool* aWasException);
+
+  private:
+    std::string mName;
+    ObjRef<iface::CGRS::GenericType> mReturnType;
+    MockInvoker mInvoker;
+    std::vector<iface::CGRS::GenericParameter*> mParameters;
+  };
+
+  class MockAttribute
+    : public virtual iface::CGRS::GenericAttribute
+  {
+    MOCK_REFCOUNT
+
+    MockAttribute(const std::string& aName, iface::CGRS::GenericType* aType,
+                  iface::CGRS::GenericMethod* aGetter, iface::CGRS::GenericMethod* aSetter)
+      : mRefcount(1), mName(aName), mType(aType), mGetter(aGetter), mSetter(aSetter)
+    {
+    }
+
+    MOCK_QI_BEGIN
+    MOCK_QI(CGRS::GenericAttribute)
+    MOCK_QI_END
+
+    std::vector<std::string> supported_interfaces() throw()
+    {
+      std::vector<std::string> v;
+      v.push_back("XPCOM::IObject");
+      v.push_back("CGRS::GenericAttribute");
+      return v;
+    }
+
+    std::string name() { return mName; }
+    bool isReadonly() { return mSetter == NULL; }
+
+    already_AddRefd<iface::CGRS::GenericType> type()
+    {
+      mType->add_ref();
+      return mType.getPointer();
+    }
+
+    already_AddRefd<iface::CGRS::GenericMethod> getter()
+    {
+      mGetter->add_ref();
+      return mGetter.getPointer();
+    }
+
+    already_AddRefd<iface::CGRS::GenericMethod> setter()
+    {
+      if (mSetter == NULL)
+        throw iface::CellML_APISPEC::CellMLException();
+      mSetter->add_ref();
+      return mSetter.getPointer();
+    }
+
+  private:
+    std::string mName;
+    ObjRef<iface::CGRS::GenericType> mType;
+    ObjRef<iface::CGRS::GenericMethod> mGetter, mSetter;
+  };
+
+  class MockInterface
+    : public virtual iface::CGRS::GenericInterface
+  {
+    MOCK_REFCOUNT
+
+    MockInterface(const std::string& aName)
+      : mRefcount(1), mName(aName)
+    {
+    }
+
+    ~MockInterface()
+    {
+      for (std::vector<iface::CGRS::GenericAttribute*>::iterator i = mAttributes.begin();
+           i != mAttributes.end(); i++)
+        (*i)->release_ref();
+      for (std::vector<iface::CGRS::GenericMethod*>::iterator i = mOperations.begin();
+           i != mOperations.end(); i++)
+        (*i)->release_ref();
+    }
+
+    MOCK_QI_BEGIN
+    MOCK_QI(CGRS::GenericType)
+    MOCK_QI(CGRS::GenericInterface)
+    MOCK_QI_END
+
+    std::vector<std::string> supported_interfaces() throw()
+    {
+      std::vector<std::string> v;
+      v.push_back("XPCOM::IObject");
+      v.push_back("CGRS::GenericType");
+      v.push_back("CGRS::GenericInterface");
+      return v;
+    }
+
+    std::string asString() { return mName; }
+
+    int32_t baseCount() { return 0; }
+    already_AddRefd<iface::CGRS::GenericInterface> getBase(int32_t aIndex)
+    {
+      throw iface::CellML_APISPEC::CellMLException();
+    }
+
+    int32_t attributeCount() { return static_cast<int32_t>(mAttributes.size()); }
+    already_AddRefd<iface::CGRS::GenericAttribute> getAttributeByIndex(int32_t aIndex)
+    {
+      if (aIndex < 0 || aIndex >= attributeCount())
+        throw iface::CellML_APISPEC::CellMLException();
+      mAttributes[aIndex]->add_ref();
+      return mAttributes[aIndex];
+    }
+
+    already_AddRefd<iface::CGRS::GenericAttribute> getAttributeByName(const std::string& aName)
+    {
+      gReflectionCalls++;
+      for (std::vector<iface::CGRS::GenericAttribute*>::iterator i = mAttributes.begin();
+           i != mAttributes.end(); i++)
+        if ((*i)->name() == aName)
+        {
+          (*i)->add_ref();
+          return *i;
+        }
+      gReflectionMisses++;
+      throw iface::CellML_APISPEC::CellMLException();
+    }
+
+    int32_t operationCount() { return static_cast<int32_t>(mOperations.size()); }
+    already_AddRefd<iface::CGRS::GenericMethod> getOperationByIndex(int32_t aIndex)
+    {
+      if (aIndex < 0 || aIndex >= operationCount())
+        throw iface::CellML_APISPEC::CellMLException();
+      mOperations[aIndex]->add_ref();
+      return mOperations[aIndex];
+    }
+
+    already_AddRefd<iface::CGRS::GenericMethod> getOperationByName(const std::string& aName)
+    {
+      gReflectionCalls++;
+      for (std::vector<iface::CGRS::GenericMethod*>::iterator i = mOperations.begin();
+           i != mOperations.end(); i++)
+        if ((*i)->name() == aName)
+        {
+          (*i)->add_ref();
+          return *i;
+        }
+      gReflectionMisses++;
+      throw iface::CellML_APISPEC::CellMLException();
+    }
+
+    MockMethod* operation(const std::string& aName, const std::string& aReturnType,
+                          const MockInvoker& aInvoker);
+    void attribute(const std::string& aName, const std::string& aType,
+                   const MockInvoker& aGetter, const MockInvoker& aSetter = MockInvoker());
+
+  private:
+    std::string mName;
+    std::vector<iface::CGRS::GenericAttribute*> mAttributes;
+    std::vector<iface::CGRS::GenericMethod*> mOperations;
+  };
+
+  // Every synthetic native object derives from MockObject; GenericMethod
+  // invocations find their target through it.
+  class MockObject
+    : public virtual iface::XPCOM::IObject
+  {
+    MOCK_REFCOUNT
+
+    MockObject(const std::vector<std::string>& aInterfaces)
+      : mRefcount(1), mInterfaces(aInterfaces)
+    {
+    }
+
+    virtual ~MockObject() {}
+
+    void* query_interface(const std::string& aIface) throw()
+    {
+      if (aIface == "XPCOM::IObject")
+      {
+        add_ref();
+        return reinterpret_cast<void*>(static_cast<iface::XPCOM::IObject*>(this));
+      }
+      return NULL;
+    }
+
+    std::vector<std::string> supported_interfaces() throw()
+    {
+      return mInterfaces;
+    }
+
+  private:
+    std::vector<std::string> mInterfaces;
+  };
+
+  class MockGenericsService
+    : public virtual iface::CGRS::GenericsService
+  {
+    MOCK_REFCOUNT
+
+    MockGenericsService()
+      : mRefcount(1)
+    {
+      const char* builtins[] = {
+        "void", "boolean", "char", "octet", "short", "long", "long long",
+        "unsigned short", "unsigned long", "unsigned long long", "float",
+        "double", "string", "wstring", "XPCOM::IObject"
+      };
+      for (size_t i = 0; i < sizeof(builtins) / sizeof(builtins[0]); i++)
+        mTypes[builtins[i]] = new MockType(builtins[i]);
+    }
+
+    MOCK_QI_BEGIN
+    MOCK_QI(CGRS::GenericsService)
+    MOCK_QI_END
+
+    std::vector<std::string> supported_interfaces() throw()
+    {
+      std::vector<std::string> v;
+      v.push_back("XPCOM::IObject");
+      v.push_back("CGRS::GenericsService");
+      return v;
+    }
+
+    void loadGenericModule(const std::string& aModuleName);
+
+    already_AddRefd<iface::CGRS::GenericType> getTypeByName(const std::string& aName)
+    {
+      std::lock_guard<std::mutex> lock(mLock);
+      std::map<std::string, ObjRef<iface::CGRS::GenericType> >::iterator i = mTypes.find(aName);
+      if (i == mTypes.end())
+        throw iface::CellML_APISPEC::CellMLException();
+      i->second->add_ref();
+      return i->second.getPointer();
+    }
+
+    already_AddRefd<iface::CGRS::GenericInterface> getInterfaceByName(const std::string& aName)
+    {
+      gReflectionCalls++;
+      std::lock_guard<std::mutex> lock(mLock);
+      std::map<std::string, ObjRef<MockInterface> >::iterator i = mInterfaces.find(aName);
+      if (i == mInterfaces.end())
+      {
+        gReflectionMisses++;
+        throw iface::CellML_APISPEC::CellMLException();
+      }
+      i->second->add_ref();
+      return static_cast<iface::CGRS::GenericInterface*>(i->second.getPointer());
+    }
+
+    already_AddRefd<iface::CGRS::GenericValue> getBootstrapByName(const std::string& aName)
+    {
+      std::function<iface::XPCOM::IObject*()> factory;
+      {
+        std::lock_guard<std::mutex> lock(mLock);
+        std::map<std::string, std::function<iface::XPCOM::IObject*()> >::iterator i =
+          mBootstraps.find(aName);
+        if (i == mBootstraps.end())
+          throw iface::CellML_APISPEC::CellMLException();
+        factory = i->second;
+      }
+      ObjRef<iface::XPCOM::IObject> obj((already_AddRefd<iface::XPCOM::IObject>(factory())));
+      return makeObject(obj);
+    }
+
+    already_AddRefd<iface::CGRS::GenericValue> makeVoid() { return new MockVoidValue(); }
+    already_AddRefd<iface::CGRS::GenericValue> makeString(const std::string& aValue) { return new MockStringValue(aValue); }
+    already_AddRefd<iface::CGRS::GenericValue> makeWString(const std::wstring& aValue) { return new MockWStringValue(aValue); }
+    already_AddRefd<iface::CGRS::GenericValue> makeShort(int16_t aValue) { return new MockShortValue(aValue); }
+    already_AddRefd<iface::CGRS::GenericValue> makeLong(int32_t aValue) { return new MockLongValue(aValue); }
+    already_AddRefd<iface::CGRS::GenericValue> makeLongLong(int64_t aValue) { return new MockLongLongValue(aValue); }
+    already_AddRefd<iface::CGRS::GenericValue> makeUShort(uint16_t aValue) { return new MockUShortValue(aValue); }
+    already_AddRefd<iface::CGRS::GenericValue> makeULong(uint32_t aValue) { return new MockULongValue(aValue); }
+    already_AddRefd<iface::CGRS::GenericValue> makeULongLong(uint64_t aValue) { return new MockULongLongValue(aValue); }
+    already_AddRefd<iface::CGRS::GenericValue> makeFloat(float aValue) { return new MockFloatValue(aValue); }
+    already_AddRefd<iface::CGRS::GenericValue> makeDouble(double aValue) { return new MockDoubleValue(aValue); }
+    already_AddRefd<iface::CGRS::GenericValue> makeBoolean(bool aValue) { return new MockBooleanValue(aValue); }
+    already_AddRefd<iface::CGRS::GenericValue> makeChar(char aValue) { return new MockCharValue(aValue); }
+    already_AddRefd<iface::CGRS::GenericValue> makeOctet(uint8_t aValue) { return new MockOctetValue(aValue); }
+
+    already_AddRefd<iface::CGRS::GenericValue>
+    makeEnumFromString(iface::CGRS::EnumType* aType, const std::string& aValue)
+    {
+      return new MockEnumValue(aType, aType->nameToIndex(aValue));
+    }
+
+    already_AddRefd<iface::CGRS::GenericValue>
+    makeEnumFromIndex(iface::CGRS::EnumType* aType, int32_t aValue)
+    {
+      if (aValue < 0 || aValue > aType->maxIndex())
+        throw iface::CellML_APISPEC::CellMLException();
+      return new MockEnumValue(aType, aValue);
+    }
+
+    already_AddRefd<iface::CGRS::GenericValue> makeObject(iface::XPCOM::IObject* aValue)
+    {
+      return new MockObjectValue(aValue);
+    }
+
+    already_AddRefd<iface::CGRS::SequenceValue> makeSequence(iface::CGRS::GenericType* aInnerType)
+    {
+      return new MockSequenceValue(aInnerType);
+    }
+
+    // Registration helpers used by the synthetic modules.
+    MockInterface* declareInterface(const std::string& aName)
+    {
+      std::lock_guard<std::mutex> lock(mLock);
+      ObjRef<MockInterface>& slot = mInterfaces[aName];
+      if (slot == NULL)
+        slot = already_AddRefd<MockInterface>(new MockInterface(aName));
+      return slot;
+    }
+
+    bool hasInterface(const std::string& aName)
+    {
+      std::lock_guard<std::mutex> lock(mLock);
+      return mInterfaces.count(aName) != 0;
+    }
+
+    iface::CGRS::EnumType* declareEnum(const std::string& aName, const std::vector<std::string>& aValues)
+    {
+      std::lock_guard<std::mutex> lock(mLock);
+      ObjRef<iface::CGRS::GenericType>& slot = mTypes[aName];
+      if (slot == NULL)
+        slot = already_AddRefd<iface::CGRS::GenericType>(new MockEnumType(aName, aValues));
+      return dynamic_cast<iface::CGRS::EnumType*>(slot.getPointer());
+    }
+
+    void declareBootstrap(const std::string& aName, const std::function<iface::XPCOM::IObject*()>& aFactory)
+    {
+      std::lock_guard<std::mutex> lock(mLock);
+      mBootstraps[aName] = aFactory;
+    }
+
+    // Resolves a type by name, also understanding "sequence<inner>".
+    already_AddRefd<iface::CGRS::GenericType> resolveType(const std::string& aName)
+    {
+      if (aName.compare(0, 9, "sequence<") == 0)
+      {
+        ObjRef<iface::CGRS::GenericType> inner(resolveType(aName.substr(9, aName.size() - 10)));
+        return static_cast<iface::CGRS::GenericType*>(new MockSequenceType(inner));
+      }
+      return getTypeByName(aName);
+    }
+
+  private:
+    std::mutex mLock;
+    std::set<std::string> mModules;
+    std::map<std::string, ObjRef<iface::CGRS::GenericType> > mTypes;
+    std::map<std::string, ObjRef<MockInterface> > mInterfaces;
+    std::map<std::string, std::function<iface::XPCOM::IObject*()> > mBootstraps;
+  };
+
+  static MockGenericsService*
+  service()
+  {
+    static MockGenericsService* sService = new MockGenericsService();
+    return sService;
+  }
+
+  static already_AddRefd<iface::CGRS::GenericType>
+  builtinType(const std::string& aName)
+  {
+    return service()->getTypeByName(aName);
+  }
+
+  MockMethod*
+  MockMethod::param(const std::string& aName, const std::string& aType, bool aIn, bool aOut)
+  {
+    ObjRef<iface::CGRS::GenericType> t(service()->resolveType(aType));
+    return param(aName, t, aIn, aOut);
+  }
+
+  already_AddRefd<iface::CGRS::GenericValue>
+  MockMethod::invoke(iface::CGRS::GenericValue* aInvokeOn,
+                     const std::vector<iface::CGRS::GenericValue*>& aInValues,
+                     std::vector<iface::CGRS::GenericValue*>& aOutValues,
+                     bool* aWasException)
+  {
+    gInvocations++;
+    *aWasException = false;
+    DECLARE_QUERY_INTERFACE_OBJREF(ov, aInvokeOn, CGRS::ObjectValue);
+    if (ov == NULL)
+    {
+      *aWasException = true;
+      return service()->makeVoid();
+    }
+    ObjRef<iface::XPCOM::IObject> target(ov->asObject());
+    MockObject* mo = dynamic_cast<MockObject*>(target.getPointer());
+    size_t nIn = 0;
+    for (std::vector<iface::CGRS::GenericParameter*>::iterator i = mParameters.begin();
+         i != mParameters.end(); i++)
+      if ((*i)->isIn())
+        nIn++;
+    if (mo == NULL || aInValues.size() != nIn)
+    {
+      *aWasException = true;
+      return service()->makeVoid();
+    }
+    try
+    {
+      iface::CGRS::GenericValue* ret = mInvoker(mo, aInValues, aOutValues);
+      if (ret == NULL)
+        return service()->makeVoid();
+      return ret;
+    }
+    catch (...)
+    {
+      *aWasException = true;
+      return service()->makeVoid();
+    }
+  }
+
+  MockMethod*
+  MockInterface::operation(const std::string& aName, const std::string& aReturnType,
+                           const MockInvoker& aInvoker)
+  {
+    ObjRef<iface::CGRS::GenericType> rt(service()->resolveType(aReturnType));
+    MockMethod* m = new MockMethod(aName, rt, aInvoker);
+    mOperations.push_back(m);
+    return m;
+  }
+
+  void
+  MockInterface::attribute(const std::string& aName, const std::string& aType,
+                           const MockInvoker& aGetter, const MockInvoker& aSetter)
+  {
+    ObjRef<iface::CGRS::GenericType> t(service()->resolveType(aType));
+    ObjRef<iface::CGRS::GenericType> vt(builtinType("void"));
+    RETURN_INTO_OBJREF(getter, MockMethod, new MockMethod(aName, t, aGetter));
+    ObjRef<MockMethod> setter;
+    if (aSetter)
+    {
+      setter = already_AddRefd<MockMethod>(new MockMethod(aName, vt, aSetter));
+      setter->param("value", t);
+    }
+    mAttributes.push_back(new MockAttribute(aName, t, getter, setter));
+  }
+
+  // Argument helpers for the synthetic objects.
+  template<class T>
+  static ObjRef<T>
+  arg(iface::CGRS::GenericValue* aValue)
+  {
+    ObjRef<T> ret;
+    if (aValue != NULL)
+    {
+      void* p = aValue->query_interface(T::INTERFACE_NAME());
+      if (p != NULL)
+        ret = already_AddRefd<T>(reinterpret_cast<T*>(p));
+    }
+    if (ret == NULL)
+      throw iface::CellML_APISPEC::CellMLException();
+    return ret;
+  }
+
+  static iface::CGRS::GenericValue*
+  wrapObject(iface::XPCOM::IObject* aObject)
+  {
+    if (aObject == NULL)
+      return service()->makeVoid();
+    return service()->makeObject(aObject);
+  }
+
+  static iface::CGRS::GenericValue*
+  makeStringValue(const std::string& aValue)
+  {
+    return service()->makeString(aValue);
+  }
+
+  static std::string
+  syntheticString(int32_t aLength)
+  {
+    std::string s;
+    s.reserve(aLength);
+    for (int32_t i = 0; i < aLength; i++)
+      s += static_cast<char>('a' + (i % 26));
+    return s;
+  }
+
+  static iface::CGRS::GenericValue*
+  syntheticDoubles(int32_t aLength)
+  {
+    ObjRef<iface::CGRS::GenericType> dt(builtinType("double"));
+    iface::CGRS::SequenceValue* sv = service()->makeSequence(dt);
+    for (int32_t i = 0; i < aLength; i++)
+    {
+      ObjRef<iface::CGRS::GenericValue> v(service()->makeDouble(i * 0.5));
+      sv->appendValue(v);
+    }
+    return sv;
+  }
+
+  // Mock::Thing: a model-element-like object with one member of each common
+  // type.
+  class Thing
+    : public MockObject
+  {
+  public:
+    Thing(int32_t aIndex)
+      : MockObject(std::vector<std::string>(1, "Mock::Thing")),
+        mIndex(aIndex), mValue(aIndex), mKind(0)
+    {
+      std::ostringstream ss;
+      ss << "thing" << aIndex;
+      mName = ss.str();
+      mWName = std::wstring(mName.begin(), mName.end());
+    }
+
+    int32_t mIndex;
+    std::string mName;
+    std::wstring mWName;
+    double mValue;
+    int32_t mKind;
+  };
+
+  class ThingIterator
+    : public MockObject
+  {
+  public:
+    ThingIterator(const std::vector<ObjRef<Thing> >& aThings, int32_t aFailAt)
+      : MockObject(std::vector<std::string>(1, "Mock::ThingIterator")),
+        mThings(aThings), mPosition(0), mFailAt(aFailAt)
+    {
+    }
+
+    std::vector<ObjRef<Thing> > mThings;
+    size_t mPosition;
+    // The position at which next() throws, or -1.
+    int32_t mFailAt;
+  };
+
+  class ThingSet
+    : public MockObject
+  {
+  public:
+    ThingSet(int32_t aCount)
+      : MockObject(std::vector<std::string>(1, "Mock::ThingSet")), mFailAt(-1)
+    {
+      for (int32_t i = 0; i < aCount; i++)
+        mThings.push_back(already_AddRefd<Thing>(new Thing(i)));
+    }
+
+    std::vector<ObjRef<Thing> > mThings;
+    // Passed to the iterators made after it is set.
+    int32_t mFailAt;
+  };
+
+  // An object supporting many interfaces, each with many members, for
+  // exercising member lookup.
+  class WideObject
+    : public MockObject
+  {
+  public:
+    WideObject(const std::vector<std::string>& aInterfaces)
+      : MockObject(aInterfaces)
+    {
+    }
+  };
+
+  // Drives a progress observer the way the CellML Integration Service does:
+  // results arrive as chunks of row-major doubles, followed by done().
+  class IntegrationRun
+    : public MockObject
+  {
+  public:
+    IntegrationRun(int32_t aChunkCount, int32_t aRowsPerChunk, int32_t aColumnCount)
+      : MockObject(std::vector<std::string>(1, "Mock::IntegrationRun")),
+        mChunkCount(aChunkCount), mRowsPerChunk(aRowsPerChunk), mColumnCount(aColumnCount)
+    {
+    }
+
+    void run()
+    {
+      ObjRef<iface::CGRS::GenericValue> observer(mObserver);
+      if (observer == NULL)
+        return;
+      DECLARE_QUERY_INTERFACE_OBJREF(cov, observer, CGRS::CallbackObjectValue);
+      if (cov == NULL)
+        return;
+      ObjRef<iface::CGRS::GenericType> dt(builtinType("double"));
+      const std::string ifname("cellml_services::IntegrationProgressObserver");
+      for (int32_t c = 0; c < mChunkCount; c++)
+      {
+        ObjRef<iface::CGRS::SequenceValue> chunk(service()->makeSequence(dt));
+        for (int32_t r = 0; r < mRowsPerChunk; r++)
+          for (int32_t col = 0; col < mColumnCount; col++)
+          {
+            double row = static_cast<double>(c) * mRowsPerChunk + r;
+            ObjRef<iface::CGRS::GenericValue> v(service()->makeDouble(row + col * 0.001));
+            chunk->appendValue(v);
+          }
+        std::vector<iface::CGRS::GenericValue*> in, out;
+        in.push_back(chunk);
+        bool wasException = false;
+        ObjRef<iface::CGRS::GenericValue> ret(cov->invokeOnInterface(ifname, "results", in, out, &wasException));
+        for (std::vector<iface::CGRS::GenericValue*>::iterator i = out.begin(); i != out.end(); i++)
+          (*i)->release_ref();
+        if (wasException)
+        {
+          ObjRef<iface::CGRS::GenericValue> why(service()->makeString("observer raised an exception"));
+          std::vector<iface::CGRS::GenericValue*> fin, fout;
+          fin.push_back(why);
+          ObjRef<iface::CGRS::GenericValue> fret(cov->invokeOnInterface(ifname, "failed", fin, fout, &wasException));
+          return;
+        }
+      }
+      std::vector<iface::CGRS::GenericValue*> in, out;
+      bool wasException = false;
+      ObjRef<iface::CGRS::GenericValue> ret(cov->invokeOnInterface(ifname, "done", in, out, &wasException));
+    }
+
+    int32_t mChunkCount, mRowsPerChunk, mColumnCount;
+    ObjRef<iface::CGRS::GenericValue> mObserver;
+  };
+
+  class Service
+    : public MockObject
+  {
+  public:
+    Service()
+      : MockObject(std::vector<std::string>(1, "Mock::Service"))
+    {
+    }
+  };
+
+  template<class T>
+  static T*
+  self(MockObject* aObject)
+  {
+    T* t = dynamic_cast<T*>(aObject);
+    if (t == NULL)
+      throw iface::CellML_APISPEC::CellMLException();
+    return t;
+  }
+
+  typedef const std::vector<iface::CGRS::GenericValue*>& In;
+  typedef std::vector<iface::CGRS::GenericValue*>& Out;
+
+  static void
+  declareWideInterfaces(int32_t aInterfaceCount, int32_t aMembersPerInterface,
+                        std::vector<std::string>& aNames)
+  {
+    for (int32_t k = 0; k < aInterfaceCount; k++)
+    {
+      std::ostringstream ss;
+      ss << "Mock::Wide" << aMembersPerInterface << "_" << k;
+      std::string name = ss.str();
+      aNames.push_back(name);
+      if (service()->hasInterface(name))
+        continue;
+      MockInterface* mi = service()->declareInterface(name);
+      for (int32_t m = 0; m < aMembersPerInterface; m++)
+      {
+        std::ostringstream an, on;
+        an << "attr" << k << "_" << m;
+        on << "op" << k << "_" << m;
+        int32_t v = k * 1000 + m;
+        mi->attribute(an.str(), "long",
+                      [v](MockObject*, In, Out) { return service()->makeLong(v); });
+        mi->operation(on.str(), "long",
+                      [v](MockObject*, In, Out) { return service()->makeLong(v); });
+      }
+    }
+  }
+
+  static void
+  declareMockModule()
+  {
+    MockGenericsService* s = service();
+
+    std::vector<std::string> kinds;
+    kinds.push_back("ALPHA");
+    kinds.push_back("BETA");
+    kinds.push_back("GAMMA");
+    iface::CGRS::EnumType* kindType = s->declareEnum("Mock::Kind", kinds);
+    ObjRef<iface::CGRS::EnumType> kindRef(kindType);
+
+    MockInterface* po = s->declareInterface("cellml_services::IntegrationProgressObserver");
+    po->operation("computedConstants", "void", [](MockObject*, In, Out) { return (iface::CGRS::GenericValue*)NULL; })
+      ->param("values", "sequence<double>");
+    po->operation("results", "void", [](MockObject*, In, Out) { return (iface::CGRS::GenericValue*)NULL; })
+      ->param("state", "sequence<double>");
+    po->operation("done", "void", [](MockObject*, In, Out) { return (iface::CGRS::GenericValue*)NULL; });
+    po->operation("failed", "void", [](MockObject*, In, Out) { return (iface::CGRS::GenericValue*)NULL; })
+      ->param("errorMessage", "string");
+
+    MockInterface* thing = s->declareInterface("Mock::Thing");
+    thing->attribute("name", "string",
+                     [](MockObject* o, In, Out) { return makeStringValue(self<Thing>(o)->mName); },
+                     [](MockObject* o, In in, Out) { self<Thing>(o)->mName = arg<iface::CGRS::StringValue>(in[0])->asString(); return (iface::CGRS::GenericValue*)NULL; });
+    thing->attribute("wname", "wstring",
+                     [](MockObject* o, In, Out) { return (iface::CGRS::GenericValue*)service()->makeWString(self<Thing>(o)->mWName); },
+                     [](MockObject* o, In in, Out) { self<Thing>(o)->mWName = arg<iface::CGRS::WStringValue>(in[0])->asWString(); return (iface::CGRS::GenericValue*)NULL; });
+    thing->attribute("value", "double",
+                     [](MockObject* o, In, Out) { return (iface::CGRS::GenericValue*)service()->makeDouble(self<Thing>(o)->mValue); },
+                     [](MockObject* o, In in, Out) { self<Thing>(o)->mValue = arg<iface::CGRS::DoubleValue>(in[0])->asDouble(); return (iface::CGRS::GenericValue*)NULL; });
+    thing->attribute("index", "long",
+                     [](MockObject* o, In, Out) { return (iface::CGRS::GenericValue*)service()->makeLong(self<Thing>(o)->mIndex); });
+    thing->attribute("kind", "Mock::Kind",
+                     [kindType](MockObject* o, In, Out) { return (iface::CGRS::GenericValue*)service()->makeEnumFromIndex(kindType, self<Thing>(o)->mKind); },
+                     [](MockObject* o, In in, Out) { self<Thing>(o)->mKind = arg<iface::CGRS::EnumValue>(in[0])->asLong(); return (iface::CGRS::GenericValue*)NULL; });
+    thing->attribute("text", "string",
+                     [](MockObject*, In, Out) { return makeStringValue(syntheticString(gStringLength)); });
+    thing->attribute("wtext", "wstring",
+                     [](MockObject*, In, Out)
+                     {
+                       std::string s(syntheticString(gStringLength));
+                       return (iface::CGRS::GenericValue*)service()->makeWString(std::wstring(s.begin(), s.end()));
+                     });
+    thing->attribute("values", "sequence<double>",
+                     [](MockObject*, In, Out) { return syntheticDoubles(gSequenceLength); });
+    thing->attribute("self", "XPCOM::IObject",
+                     [](MockObject* o, In, Out) { return wrapObject(o); });
+    thing->operation("scaled", "double",
+                     [](MockObject* o, In in, Out)
+                     {
+                       return (iface::CGRS::GenericValue*)service()->makeDouble(self<Thing>(o)->mValue * arg<iface::CGRS::DoubleValue>(in[0])->asDouble());
+                     })->param("factor", "double");
+    thing->operation("split", "long",
+                     [](MockObject* o, In, Out out)
+                     {
+                       Thing* t = self<Thing>(o);
+                       out.push_back(service()->makeString(t->mName));
+                       return (iface::CGRS::GenericValue*)service()->makeLong(t->mIndex);
+                     })->param("name", "string", false, true);
+    thing->operation("fail", "void",
+                     [](MockObject*, In, Out) -> iface::CGRS::GenericValue* { throw iface::CellML_APISPEC::CellMLException(); });
+
+    MockInterface* iter = s->declareInterface("Mock::ThingIterator");
+    iter->operation("next", "XPCOM::IObject",
+                    [](MockObject* o, In, Out)
+                    {
+                      ThingIterator* ti = self<ThingIterator>(o);
+                      if (ti->mFailAt >= 0 && ti->mPosition == static_cast<size_t>(ti->mFailAt))
+                        throw iface::CellML_APISPEC::CellMLException();
+                      if (ti->mPosition >= ti->mThings.size())
+                        return wrapObject(NULL);
+                      return wrapObject(ti->mThings[ti->mPosition++]);
+                    });
+
+    MockInterface* set = s->declareInterface("Mock::ThingSet");
+    set->attribute("length", "long",
+                   [](MockObject* o, In, Out) { return (iface::CGRS::GenericValue*)service()->makeLong(self<ThingSet>(o)->mThings.size()); });
+    set->attribute("failAt", "long",
+                   [](MockObject* o, In, Out) { return (iface::CGRS::GenericValue*)service()->makeLong(self<ThingSet>(o)->mFailAt); },
+                   [](MockObject* o, In in, Out) { self<ThingSet>(o)->mFailAt = arg<iface::CGRS::LongValue>(in[0])->asLong(); return (iface::CGRS::GenericValue*)NULL; });
+    set->operation("iterate", "XPCOM::IObject",
+                   [](MockObject* o, In, Out)
+                   {
+                     ThingSet* ts = self<ThingSet>(o);
+                     RETURN_INTO_OBJREF(ti, ThingIterator, new ThingIterator(ts->mThings, ts->mFailAt));
+                     return wrapObject(ti);
+                   });
+    set->operation("getByIndex", "XPCOM::IObject",
+                   [](MockObject* o, In in, Out)
+                   {
+                     ThingSet* ts = self<ThingSet>(o);
+                     int32_t idx = arg<iface::CGRS::LongValue>(in[0])->asLong();
+                     if (idx < 0 || static_cast<size_t>(idx) >= ts->mThings.size())
+                       return wrapObject(NULL);
+                     return wrapObject(ts->mThings[idx]);
+                   })->param("index", "long");
+
+    MockInterface* run = s->declareInterface("Mock::IntegrationRun");
+    run->operation("setProgressObserver", "void",
+                   [](MockObject* o, In in, Out)
+                   {
+                     self<IntegrationRun>(o)->mObserver = in[0];
+                     return (iface::CGRS::GenericValue*)NULL;
+                   })->param("observer", "XPCOM::IObject");
+    run->operation("start", "void",
+                   [](MockObject* o, In, Out)
+                   {
+                     IntegrationRun* ir = self<IntegrationRun>(o);
+                     ir->add_ref();
+                     std::thread([ir]() { ir->run(); ir->release_ref(); }).detach();
+                     return (iface::CGRS::GenericValue*)NULL;
+                   });
+    run->operation("runSynchronously", "void",
+                   [](MockObject* o, In, Out)
+                   {
+                     self<IntegrationRun>(o)->run();
+                     return (iface::CGRS::GenericValue*)NULL;
+                   });
+    run->attribute("columnCount", "long",
+                   [](MockObject* o, In, Out) { return (iface::CGRS::GenericValue*)service()->makeLong(self<IntegrationRun>(o)->mColumnCount); });
+
+    MockInterface* svc = s->declareInterface("Mock::Service");
+    svc->attribute("stringLength", "long",
+                   [](MockObject*, In, Out) { return (iface::CGRS::GenericValue*)service()->makeLong(gStringLength); },
+                   [](MockObject*, In in, Out) { gStringLength = arg<iface::CGRS::LongValue>(in[0])->asLong(); return (iface::CGRS::GenericValue*)NULL; });
+    svc->attribute("sequenceLength", "long",
+                   [](MockObject*, In, Out) { return (iface::CGRS::GenericValue*)service()->makeLong(gSequenceLength); },
+                   [](MockObject*, In in, Out) { gSequenceLength = arg<iface::CGRS::LongValue>(in[0])->asLong(); return (iface::CGRS::GenericValue*)NULL; });
+    svc->attribute("reflectionCallCount", "long long",
+                   [](MockObject*, In, Out) { return (iface::CGRS::GenericValue*)service()->makeLongLong(gReflectionCalls); });
+    svc->attribute("reflectionMissCount", "long long",
+                   [](MockObject*, In, Out) { return (iface::CGRS::GenericValue*)service()->makeLongLong(gReflectionMisses); });
+    svc->attribute("serviceFetchCount", "long long",
+                   [](MockObject*, In, Out) { return (iface::CGRS::GenericValue*)service()->makeLongLong(gServiceFetches); });
+    svc->attribute("allocationCount", "long long",
+                   [](MockObject*, In, Out) { return (iface::CGRS::GenericValue*)service()->makeLongLong(gAllocations); });
+    svc->attribute("invocationCount", "long long",
+                   [](MockObject*, In, Out) { return (iface::CGRS::GenericValue*)service()->makeLongLong(gInvocations); });
+    svc->operation("createThing", "XPCOM::IObject",
+                   [](MockObject*, In, Out)
+                   {
+                     RETURN_INTO_OBJREF(t, Thing, new Thing(0));
+                     return wrapObject(t);
+                   });
+    svc->operation("createThingSet", "XPCOM::IObject",
+                   [](MockObject*, In in, Out)
+                   {
+                     RETURN_INTO_OBJREF(ts, ThingSet, new ThingSet(arg<iface::CGRS::LongValue>(in[0])->asLong()));
+                     return wrapObject(ts);
+                   })->param("count", "long");
+    svc->operation("createWideObject", "XPCOM::IObject",
+                   [](MockObject*, In in, Out)
+                   {
+                     std::vector<std::string> names;
+                     declareWideInterfaces(arg<iface::CGRS::LongValue>(in[0])->asLong(),
+                                           arg<iface::CGRS::LongValue>(in[1])->asLong(), names);
+                     RETURN_INTO_OBJREF(wo, WideObject, new WideObject(names));
+                     return wrapObject(wo);
+                   })->param("interfaceCount", "long")->param("membersPerInterface", "long");
+    svc->operation("createIntegrationRun", "XPCOM::IObject",
+                   [](MockObject*, In in, Out)
+                   {
+                     RETURN_INTO_OBJREF(ir, IntegrationRun,
+                                        new IntegrationRun(arg<iface::CGRS::LongValue>(in[0])->asLong(),
+                                                           arg<iface::CGRS::LongValue>(in[1])->asLong(),
+                                                           arg<iface::CGRS::LongValue>(in[2])->asLong()));
+                     return wrapObject(ir);
+                   })->param("chunkCount", "long")->param("rowsPerChunk", "long")->param("columnCount", "long");
+    svc->operation("makeDoubles", "sequence<double>",
+                   [](MockObject*, In in, Out) { return syntheticDoubles(arg<iface::CGRS::LongValue>(in[0])->asLong()); })
+      ->param("count", "long");
+    svc->operation("sumDoubles", "double",
+                   [](MockObject*, In in, Out)
+                   {
+                     ObjRef<iface::CGRS::SequenceValue> sv(arg<iface::CGRS::SequenceValue>(in[0]));
+                     double sum = 0.0;
+                     int32_t n = sv->valueCount();
+                     for (int32_t i = 0; i < n; i++)
+                     {
+                       ObjRef<iface::CGRS::GenericValue> v(sv->getValueByIndex(i));
+                       sum += arg<iface::CGRS::DoubleValue>(v)->asDouble();
+                     }
+                     return (iface::CGRS::GenericValue*)service()->makeDouble(sum);
+                   })->param("values", "sequence<double>");
+    svc->operation("sumLongs", "long long",
+                   [](MockObject*, In in, Out)
+                   {
+                     ObjRef<iface::CGRS::SequenceValue> sv(arg<iface::CGRS::SequenceValue>(in[0]));
+                     int64_t sum = 0;
+                     int32_t n = sv->valueCount();
+                     for (int32_t i = 0; i < n; i++)
+                     {
+                       ObjRef<iface::CGRS::GenericValue> v(sv->getValueByIndex(i));
+                       sum += arg<iface::CGRS::LongValue>(v)->asLong();
+                     }
+                     return (iface::CGRS::GenericValue*)service()->makeLongLong(sum);
+                   })->param("values", "sequence<long>");
+    svc->operation("echoString", "string",
+                   [](MockObject*, In in, Out) { return makeStringValue(arg<iface::CGRS::StringValue>(in[0])->asString()); })
+      ->param("value", "string");
+    svc->operation("echoWString", "wstring",
+                   [](MockObject*, In in, Out) { return (iface::CGRS::GenericValue*)service()->makeWString(arg<iface::CGRS::WStringValue>(in[0])->asWString()); })
+      ->param("value", "wstring");
+    svc->operation("wstringLength", "long",
+                   [](MockObject*, In in, Out) { return (iface::CGRS::GenericValue*)service()->makeLong(arg<iface::CGRS::WStringValue>(in[0])->asWString().size()); })
+      ->param("value", "wstring");
+    svc->operation("echoKind", "Mock::Kind",
+                   [kindType](MockObject*, In in, Out) { return (iface::CGRS::GenericValue*)service()->makeEnumFromIndex(kindType, arg<iface::CGRS::EnumValue>(in[0])->asLong()); })
+      ->param("value", "Mock::Kind");
+    svc->operation("echoObject", "XPCOM::IObject",
+                   [](MockObject*, In in, Out)
+                   {
+                     DECLARE_QUERY_INTERFACE_OBJREF(ov, in[0], CGRS::ObjectValue);
+                     if (ov == NULL)
+                       return wrapObject(NULL);
+                     ObjRef<iface::XPCOM::IObject> o(ov->asObject());
+                     return wrapObject(o);
+                   })->param("value", "XPCOM::IObject");
+    svc->operation("busyWait", "void",
+                   [](MockObject*, In in, Out)
+                   {
+                     std::chrono::steady_clock::time_point end =
+                       std::chrono::steady_clock::now() +
+                       std::chrono::microseconds(arg<iface::CGRS::LongValue>(in[0])->asLong());
+                     while (std::chrono::steady_clock::now() < end)
+                       ;
+                     return (iface::CGRS::GenericValue*)NULL;
+                   })->param("microseconds", "long");
+    svc->operation("callObserver", "void",
+                   [](MockObject*, In in, Out)
+                   {
+                     // Calls results() on an observer synchronously, count times.
+                     RETURN_INTO_OBJREF(ir, IntegrationRun,
+                                        new IntegrationRun(arg<iface::CGRS::LongValue>(in[1])->asLong(),
+                                                           arg<iface::CGRS::LongValue>(in[2])->asLong(), 1));
+                     ir->mObserver = in[0];
+                     ir->run();
+                     return (iface::CGRS::GenericValue*)NULL;
+                   })->param("observer", "XPCOM::IObject")->param("count", "long")->param("length", "long");
+
+    s->declareBootstrap("CreateMockService",
+                        []() { return static_cast<iface::XPCOM::IObject*>(new Service()); });
+  }
+
+  void
+  MockGenericsService::loadGenericModule(const std::string& aModuleName)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mLock);
+      if (mModules.count(aModuleName))
+        return;
+      if (aModuleName != "cgrs_mock")
+        throw iface::CellML_APISPEC::CellMLException();
+      mModules.insert(aModuleName);
+    }
+    declareMockModule();
+  }
+};
+
+already_AddRefd<iface::CGRS::GenericsService>
+CreateGenericsService()
+{
+  mock::gServiceFetches++;
+  mock::service()->add_ref();
+  return mock::service();
+}
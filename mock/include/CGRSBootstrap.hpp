@@ -0,0 +1,8 @@
+#ifndef _CGRSBOOTSTRAP_HPP
+#define _CGRSBOOTSTRAP_HPP
+
+#include "IfaceCGRS.hxx"
+
+already_AddRefd<iface::CGRS::GenericsService> CreateGenericsService();
+
+#endif // _CGRSBOOTSTRAP_HPP
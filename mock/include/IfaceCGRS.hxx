@@ -0,0 +1,235 @@
+#ifndef _GUARD_IFACE_CGRS
+#define _GUARD_IFACE_CGRS
+
+// Mock of the CellML Generics and Reflection Service interfaces. The layout
+// follows the C++ mapping of CGRS.idl in the CellML API, so that cgrspy
+// builds unchanged against either.
+
+#include "Ifacexpcom.hxx"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace iface
+{
+  namespace CGRS
+  {
+    class GenericType;
+    class GenericValue;
+    class GenericParameter;
+    class GenericMethod;
+    class GenericAttribute;
+    class GenericInterface;
+    class EnumType;
+    class SequenceType;
+    class SequenceValue;
+
+    typedef std::vector<iface::CGRS::GenericValue*> GenericValueSequence;
+    typedef std::vector<iface::CGRS::GenericParameter*> GenericParameterSequence;
+
+    class GenericType
+      : public virtual iface::XPCOM::IObject
+    {
+    public:
+      static const char* INTERFACE_NAME() { return "CGRS::GenericType"; }
+      virtual ~GenericType() {}
+      virtual std::string asString() = 0;
+    };
+
+    class GenericValue
+      : public virtual iface::XPCOM::IObject
+    {
+    public:
+      static const char* INTERFACE_NAME() { return "CGRS::GenericValue"; }
+      virtual ~GenericValue() {}
+      virtual already_AddRefd<iface::CGRS::GenericType> typeOfValue() = 0;
+    };
+
+    class VoidValue
+      : public virtual iface::CGRS::GenericValue
+    {
+    public:
+      static const char* INTERFACE_NAME() { return "CGRS::VoidValue"; }
+      virtual ~VoidValue() {}
+    };
+
+#define CGRS_MOCK_SCALAR_VALUE(name, ctype, getter) \
+    class name \
+      : public virtual iface::CGRS::GenericValue \
+    { \
+    public: \
+      static const char* INTERFACE_NAME() { return "CGRS::" #name; } \
+      virtual ~name() {} \
+      virtual ctype getter() = 0; \
+    };
+
+    CGRS_MOCK_SCALAR_VALUE(StringValue, std::string, asString)
+    CGRS_MOCK_SCALAR_VALUE(WStringValue, std::wstring, asWString)
+    CGRS_MOCK_SCALAR_VALUE(ShortValue, int16_t, asShort)
+    CGRS_MOCK_SCALAR_VALUE(LongValue, int32_t, asLong)
+    CGRS_MOCK_SCALAR_VALUE(LongLongValue, int64_t, asLongLong)
+    CGRS_MOCK_SCALAR_VALUE(UShortValue, uint16_t, asUShort)
+    CGRS_MOCK_SCALAR_VALUE(ULongValue, uint32_t, asULong)
+    CGRS_MOCK_SCALAR_VALUE(ULongLongValue, uint64_t, asULongLong)
+    CGRS_MOCK_SCALAR_VALUE(FloatValue, float, asFloat)
+    CGRS_MOCK_SCALAR_VALUE(DoubleValue, double, asDouble)
+    CGRS_MOCK_SCALAR_VALUE(BooleanValue, bool, asBoolean)
+    CGRS_MOCK_SCALAR_VALUE(CharValue, char, asChar)
+    CGRS_MOCK_SCALAR_VALUE(OctetValue, uint8_t, asOctet)
+
+#undef CGRS_MOCK_SCALAR_VALUE
+
+    class EnumValue
+      : public virtual iface::CGRS::GenericValue
+    {
+    public:
+      static const char* INTERFACE_NAME() { return "CGRS::EnumValue"; }
+      virtual ~EnumValue() {}
+      virtual int32_t asLong() = 0;
+      virtual std::string asString() = 0;
+    };
+
+    class ObjectValue
+      : public virtual iface::CGRS::GenericValue
+    {
+    public:
+      static const char* INTERFACE_NAME() { return "CGRS::ObjectValue"; }
+      virtual ~ObjectValue() {}
+      virtual already_AddRefd<iface::XPCOM::IObject> asObject() = 0;
+    };
+
+    class CallbackObjectValue
+      : public virtual iface::CGRS::GenericValue
+    {
+    public:
+      static const char* INTERFACE_NAME() { return "CGRS::CallbackObjectValue"; }
+      virtual ~CallbackObjectValue() {}
+      virtual already_AddRefd<iface::CGRS::GenericValue>
+      invokeOnInterface(const std::string& interfaceName,
+                        const std::string& methodName,
+                        const std::vector<iface::CGRS::GenericValue*>& inValues,
+                        std::vector<iface::CGRS::GenericValue*>& outValues,
+                        bool* wasException) = 0;
+    };
+
+    class SequenceValue
+      : public virtual iface::CGRS::GenericValue
+    {
+    public:
+      static const char* INTERFACE_NAME() { return "CGRS::SequenceValue"; }
+      virtual ~SequenceValue() {}
+      virtual int32_t valueCount() = 0;
+      virtual already_AddRefd<iface::CGRS::GenericValue> getValueByIndex(int32_t index) = 0;
+      virtual void appendValue(iface::CGRS::GenericValue* value) = 0;
+    };
+
+    class GenericParameter
+      : public virtual iface::XPCOM::IObject
+    {
+    public:
+      static const char* INTERFACE_NAME() { return "CGRS::GenericParameter"; }
+      virtual ~GenericParameter() {}
+      virtual bool isIn() = 0;
+      virtual bool isOut() = 0;
+      virtual std::string name() = 0;
+      virtual already_AddRefd<iface::CGRS::GenericType> type() = 0;
+    };
+
+    class GenericMethod
+      : public virtual iface::XPCOM::IObject
+    {
+    public:
+      static const char* INTERFACE_NAME() { return "CGRS::GenericMethod"; }
+      virtual ~GenericMethod() {}
+      virtual std::string name() = 0;
+      virtual std::vector<iface::CGRS::GenericParameter*> parameters() = 0;
+      virtual already_AddRefd<iface::CGRS::GenericType> returnType() = 0;
+      virtual already_AddRefd<iface::CGRS::GenericValue>
+      invoke(iface::CGRS::GenericValue* invokeOn,
+             const std::vector<iface::CGRS::GenericValue*>& inValues,
+             std::vector<iface::CGRS::GenericValue*>& outValues,
+             bool* wasException) = 0;
+    };
+
+    class GenericAttribute
+      : public virtual iface::XPCOM::IObject
+    {
+    public:
+      static const char* INTERFACE_NAME() { return "CGRS::GenericAttribute"; }
+      virtual ~GenericAttribute() {}
+      virtual std::string name() = 0;
+      virtual bool isReadonly() = 0;
+      virtual already_AddRefd<iface::CGRS::GenericType> type() = 0;
+      virtual already_AddRefd<iface::CGRS::GenericMethod> getter() = 0;
+      virtual already_AddRefd<iface::CGRS::GenericMethod> setter() = 0;
+    };
+
+    class GenericInterface
+      : public virtual iface::CGRS::GenericType
+    {
+    public:
+      static const char* INTERFACE_NAME() { return "CGRS::GenericInterface"; }
+      virtual ~GenericInterface() {}
+      virtual int32_t baseCount() = 0;
+      virtual already_AddRefd<iface::CGRS::GenericInterface> getBase(int32_t index) = 0;
+      virtual int32_t attributeCount() = 0;
+      virtual already_AddRefd<iface::CGRS::GenericAttribute> getAttributeByIndex(int32_t index) = 0;
+      virtual already_AddRefd<iface::CGRS::GenericAttribute> getAttributeByName(const std::string& name) = 0;
+      virtual int32_t operationCount() = 0;
+      virtual already_AddRefd<iface::CGRS::GenericMethod> getOperationByIndex(int32_t index) = 0;
+      virtual already_AddRefd<iface::CGRS::GenericMethod> getOperationByName(const std::string& name) = 0;
+    };
+
+    class EnumType
+      : public virtual iface::CGRS::GenericType
+    {
+    public:
+      static const char* INTERFACE_NAME() { return "CGRS::EnumType"; }
+      virtual ~EnumType() {}
+      virtual int32_t maxIndex() = 0;
+      virtual std::string indexToName(int32_t index) = 0;
+      virtual int32_t nameToIndex(const std::string& name) = 0;
+    };
+
+    class SequenceType
+      : public virtual iface::CGRS::GenericType
+    {
+    public:
+      static const char* INTERFACE_NAME() { return "CGRS::SequenceType"; }
+      virtual ~SequenceType() {}
+      virtual already_AddRefd<iface::CGRS::GenericType> innerType() = 0;
+    };
+
+    class GenericsService
+      : public virtual iface::XPCOM::IObject
+    {
+    public:
+      static const char* INTERFACE_NAME() { return "CGRS::GenericsService"; }
+      virtual ~GenericsService() {}
+      virtual void loadGenericModule(const std::string& moduleName) = 0;
+      virtual already_AddRefd<iface::CGRS::GenericType> getTypeByName(const std::string& name) = 0;
+      virtual already_AddRefd<iface::CGRS::GenericInterface> getInterfaceByName(const std::string& name) = 0;
+      virtual already_AddRefd<iface::CGRS::GenericValue> getBootstrapByName(const std::string& name) = 0;
+      virtual already_AddRefd<iface::CGRS::GenericValue> makeVoid() = 0;
+      virtual already_AddRefd<iface::CGRS::GenericValue> makeString(const std::string& value) = 0;
+      virtual already_AddRefd<iface::CGRS::GenericValue> makeWString(const std::wstring& value) = 0;
+      virtual already_AddRefd<iface::CGRS::GenericValue> makeShort(int16_t value) = 0;
+      virtual already_AddRefd<iface::CGRS::GenericValue> makeLong(int32_t value) = 0;
+      virtual already_AddRefd<iface::CGRS::GenericValue> makeLongLong(int64_t value) = 0;
+      virtual already_AddRefd<iface::CGRS::GenericValue> makeUShort(uint16_t value) = 0;
+      virtual already_AddRefd<iface::CGRS::GenericValue> makeULong(uint32_t value) = 0;
+      virtual already_AddRefd<iface::CGRS::GenericValue> makeULongLong(uint64_t value) = 0;
+      virtual already_AddRefd<iface::CGRS::GenericValue> makeFloat(float value) = 0;
+      virtual already_AddRefd<iface::CGRS::GenericValue> makeDouble(double value) = 0;
+      virtual already_AddRefd<iface::CGRS::GenericValue> makeBoolean(bool value) = 0;
+      virtual already_AddRefd<iface::CGRS::GenericValue> makeChar(char value) = 0;
+      virtual already_AddRefd<iface::CGRS::GenericValue> makeOctet(uint8_t value) = 0;
+      virtual already_AddRefd<iface::CGRS::GenericValue> makeEnumFromString(iface::CGRS::EnumType* type, const std::string& value) = 0;
+      virtual already_AddRefd<iface::CGRS::GenericValue> makeEnumFromIndex(iface::CGRS::EnumType* type, int32_t value) = 0;
+      virtual already_AddRefd<iface::CGRS::GenericValue> makeObject(iface::XPCOM::IObject* value) = 0;
+      virtual already_AddRefd<iface::CGRS::SequenceValue> makeSequence(iface::CGRS::GenericType* innerType) = 0;
+    };
+  };
+};
+
+#endif // _GUARD_IFACE_CGRS
@@ -0,0 +1,41 @@
+#ifndef _GUARD_IFACE_XPCOM
+#define _GUARD_IFACE_XPCOM
+
+// Mock of the CellML API XPCOM base interface.
+
+#include "cellml-api-cxx-support.hpp"
+#include <exception>
+#include <string>
+#include <vector>
+
+namespace iface
+{
+  namespace XPCOM
+  {
+    class IObject
+    {
+    public:
+      static const char* INTERFACE_NAME() { return "XPCOM::IObject"; }
+      virtual ~IObject() {}
+      virtual void add_ref() throw() = 0;
+      virtual void release_ref() throw() = 0;
+      virtual std::string objid() throw() = 0;
+      virtual void* query_interface(const std::string& id) throw() = 0;
+      virtual std::vector<std::string> supported_interfaces() throw() = 0;
+    };
+  };
+
+  namespace CellML_APISPEC
+  {
+    class CellMLException
+      : public std::exception
+    {
+    public:
+      CellMLException() {}
+      ~CellMLException() throw() {}
+      const char* what() const throw() { return "CellMLException"; }
+    };
+  };
+};
+
+#endif // _GUARD_IFACE_XPCOM
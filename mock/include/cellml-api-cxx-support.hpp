@@ -0,0 +1,141 @@
+#ifndef _CELLML_API_CXX_SUPPORT_HPP
+#define _CELLML_API_CXX_SUPPORT_HPP
+
+// Minimal subset of the CellML API C++ support templates, sufficient to build
+// cgrspy against the in-tree mock CGRS.
+
+#include <cstddef>
+
+template<class T>
+class already_AddRefd
+{
+public:
+  already_AddRefd(T* aPtr)
+    : mPtr(aPtr)
+  {
+  }
+
+  T* getPointer() const
+  {
+    return mPtr;
+  }
+
+  T* operator->() const
+  {
+    return mPtr;
+  }
+
+  operator T*() const
+  {
+    return mPtr;
+  }
+
+private:
+  T* mPtr;
+};
+
+template<class T>
+class ObjRef
+{
+public:
+  ObjRef()
+    : mPtr(NULL)
+  {
+  }
+
+  ObjRef(const ObjRef<T>& aPtr)
+  {
+    mPtr = aPtr.getPointer();
+    if (mPtr != NULL)
+      mPtr->add_ref();
+  }
+
+  ObjRef(T* aPtr)
+    : mPtr(aPtr)
+  {
+    if (mPtr != NULL)
+      mPtr->add_ref();
+  }
+
+  template<class U>
+  ObjRef(const already_AddRefd<U>& aar)
+  {
+    mPtr = aar.getPointer();
+  }
+
+  ~ObjRef()
+  {
+    if (mPtr != NULL)
+      mPtr->release_ref();
+  }
+
+  T* operator->() const
+  {
+    return mPtr;
+  }
+
+  T* getPointer() const
+  {
+    return mPtr;
+  }
+
+  operator T*() const
+  {
+    return mPtr;
+  }
+
+  void operator=(T* aNewAssign)
+  {
+    if (aNewAssign != NULL)
+      aNewAssign->add_ref();
+    if (mPtr != NULL)
+      mPtr->release_ref();
+    mPtr = aNewAssign;
+  }
+
+  void operator=(const ObjRef<T>& aNewAssign)
+  {
+    *this = aNewAssign.getPointer();
+  }
+
+  template<class U>
+  void operator=(const already_AddRefd<U>& aNewAssign)
+  {
+    if (mPtr != NULL)
+      mPtr->release_ref();
+    mPtr = aNewAssign.getPointer();
+  }
+
+private:
+  T* mPtr;
+};
+
+#define RETURN_INTO_OBJREF(lhs, type, rhs) \
+  ObjRef<type> lhs \
+  ( \
+    already_AddRefd<type> \
+    ( \
+      static_cast<type*> \
+      ( \
+        rhs \
+      ) \
+    ) \
+  )
+
+#define QUERY_INTERFACE(lhs, rhs, type) \
+  if (rhs != NULL) \
+  { \
+    void* _qicast_obj = rhs->query_interface(#type); \
+    if (_qicast_obj != NULL) \
+      lhs = already_AddRefd<iface::type>(reinterpret_cast<iface::type*>(_qicast_obj)); \
+    else \
+      lhs = NULL; \
+  } \
+  else \
+    lhs = NULL;
+
+#define DECLARE_QUERY_INTERFACE_OBJREF(lhs, rhs, type) \
+  ObjRef<iface::type> lhs; \
+  QUERY_INTERFACE(lhs, rhs, type)
+
+#endif // _CELLML_API_CXX_SUPPORT_HPP
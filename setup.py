@@ -14,19 +14,69 @@ import sys
 import os
 from os.path import join
 
-ppath = lambda *p: p and join("..", *p) or ".."
-include_dirs = [ppath(i) for i in ["interfaces", "", "sources", "CGRS"]]
-library_dirs = [".."]
+# With --mock, build against the stand-in CGRS in mock/ instead of a CellML
+# API build in "..", so that the binding can be tested and benchmarked on its
+# own, e.g. "python setup.py --mock build test".
+use_mock = "--mock" in sys.argv
+if use_mock:
+    sys.argv.remove("--mock")
+    include_dirs = [join("mock", "include")]
+    library_dirs = []
+    libraries = ["pthread"]
+    sources = [join("cgrspy", "cgrspy_bootstrap.cpp"), join("mock", "cgrs_mock.cpp")]
+else:
+    ppath = lambda *p: p and join("..", *p) or ".."
+    include_dirs = [ppath(i) for i in ["interfaces", "", "sources", "CGRS"]]
+    library_dirs = [".."]
+    libraries = ["cellml", "cgrs"]
+    sources = [join("cgrspy", "cgrspy_bootstrap.cpp")]
 
 
 class test_cgrspy(distutils.command.build.build):
     def run(self):
         sys.path.insert(0, self.build_lib)
-        from cgrspy.tests import test_main
-        test_main.runTests()
+        if use_mock:
+            from cgrspy.tests import test_mock as tests
+        else:
+            from cgrspy.tests import test_main as tests
+        tests.runTests()
     user_options = []
 
 
+class bench_cgrspy(distutils.command.build.build):
+    description = "run the benchmarks, optionally saving the results as JSON"
+    user_options = distutils.command.build.build.user_options + [
+        ("benchmarks=", None, "comma-separated bench_* modules to run"),
+        ("output=", None, "write the results to this JSON file"),
+        ("compare=", None, "compare the results with this earlier JSON file")]
+
+    def initialize_options(self):
+        distutils.command.build.build.initialize_options(self)
+        self.benchmarks = None
+        self.output = None
+        self.compare = None
+
+    def run(self):
+        sys.path.insert(0, self.build_lib)
+        import cgrspy.benchmarks
+        if self.benchmarks:
+            names = self.benchmarks.split(",")
+        elif use_mock:
+            names = ["boundary", "conversion"]
+        else:
+            names = ["conversion", "iteration", "allocation", "strings",
+                     "threads", "observers", "workload"]
+        for name in names:
+            if not name.startswith("bench_"):
+                name = "bench_" + name
+            module = __import__("cgrspy.benchmarks." + name, fromlist=["run"])
+            module.run()
+        if self.output:
+            cgrspy.benchmarks.writeResults(self.output)
+        if self.compare:
+            cgrspy.benchmarks.compareResults(self.compare)
+
+
 setup(name="cgrspy",
       version="1.1.1",
       description="Python interface to the CellML Generics and Reflection "
@@ -38,14 +88,15 @@ setup(name="cgrspy",
       license='GPL/LGPL/MPL',
       packages=find_packages(exclude=['ez_setup']),
       cmdclass={
-          'test': test_cgrspy
+          'test': test_cgrspy,
+          'bench': bench_cgrspy
       },
       ext_modules=[
           Extension(
               name="cgrspy.bootstrap", 
-              sources=[join("cgrspy", "cgrspy_bootstrap.cpp")],
+              sources=sources,
               include_dirs=include_dirs,
               library_dirs=library_dirs,
-              libraries=["cellml", "cgrs"])
+              libraries=libraries)
           ]
       )